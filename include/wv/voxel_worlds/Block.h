@@ -9,7 +9,7 @@ namespace WillowVox
     {
         Block() = default;
         Block(const std::string& strId, BlockId id, float texMinX, float texMaxX, float texMinY, float texMaxY, 
-            bool lightEmitter = false, int lightLevel = 16)
+            bool lightEmitter = false, int lightLevel = MAX_LIGHT_LEVEL)
             : strId(strId), id(id), topTexMinX(texMinX), topTexMaxX(texMaxX), topTexMinY(texMinY), topTexMaxY(texMaxY),
             bottomTexMinX(texMinX), bottomTexMaxX(texMaxX), bottomTexMinY(texMinY), bottomTexMaxY(texMaxY),
             sideTexMinX(texMinX), sideTexMaxX(texMaxX), sideTexMinY(texMinY), sideTexMaxY(texMaxY),
@@ -20,7 +20,7 @@ namespace WillowVox
         Block(const std::string& strId, BlockId id, float topTexMinX, float topTexMaxX, float topTexMinY, float topTexMaxY,
             float bottomTexMinX, float bottomTexMaxX, float bottomTexMinY, float bottomTexMaxY,
             float sideTexMinX, float sideTexMaxX, float sideTexMinY, float sideTexMaxY,
-            bool lightEmitter = false, int lightLevel = 16)
+            bool lightEmitter = false, int lightLevel = MAX_LIGHT_LEVEL)
             : strId(strId), id(id), topTexMinX(topTexMinX), topTexMaxX(topTexMaxX), topTexMinY(topTexMinY), topTexMaxY(topTexMaxY),
             bottomTexMinX(bottomTexMinX), bottomTexMaxX(bottomTexMaxX), bottomTexMinY(bottomTexMinY), bottomTexMaxY(bottomTexMaxY),
             sideTexMinX(sideTexMinX), sideTexMaxX(sideTexMaxX), sideTexMinY(sideTexMinY), sideTexMaxY(sideTexMaxY),
@@ -30,6 +30,8 @@ namespace WillowVox
         float topTexMinX, topTexMaxX, topTexMinY, topTexMaxY;
         float bottomTexMinX, bottomTexMaxX, bottomTexMinY, bottomTexMaxY;
         float sideTexMinX, sideTexMaxX, sideTexMinY, sideTexMaxY;
+        // Tile indices in the chunk texture atlas
+        int topTexIndex = 0, bottomTexIndex = 0, sideTexIndex = 0;
         std::string strId;
         BlockId id;
 
@@ -17,11 +17,11 @@ namespace WillowVox
         }
 
         void RegisterBlock(const std::string& strId, const std::string& texturePath,
-            bool lightEmitter = false, int lightLevel = 16);
+            bool lightEmitter = false, int lightLevel = MAX_LIGHT_LEVEL);
         void RegisterBlock(const std::string& strId, const std::string& topTexturePath,
             const std::string& bottomTexturePath,
             const std::string& sideTexturePath,
-            bool lightEmitter = false, int lightLevel = 16);
+            bool lightEmitter = false, int lightLevel = MAX_LIGHT_LEVEL);
 
         void ApplyRegistry();
 
@@ -31,6 +31,10 @@ namespace WillowVox
 
         const BlockId GetBlockId(const std::string& strId) const;
 
+        // Size of the chunk texture atlas in tiles (always a power of two)
+        int GetAtlasWidth() const { return m_atlasWidth; }
+        int GetAtlasHeight() const { return m_atlasHeight; }
+
     private:
         struct TempBlock
         {
@@ -49,5 +53,8 @@ namespace WillowVox
         std::unordered_map<std::string, int> m_tempTextures;
         int m_tempTexCounter = -1;
         std::unordered_map<std::string, TempBlock> m_tempBlockRegistry;
+
+        int m_atlasWidth = 1;
+        int m_atlasHeight = 1;
     };
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <wv/voxel_worlds/ChunkRenderer.h>
+#include <wv/voxel_worlds/ChunkMeshArena.h>
+#include <wv/voxel_worlds/ChunkDrawCommandBuilder.h>
+#include <wv/voxel_worlds/ChunkUploadQueue.h>
+#include <unordered_map>
+
+namespace WillowVox
+{
+    // Draws every queued chunk with a single glMultiDrawElementsIndirect call
+    // Chunk meshes are sub-allocated from one shared vertex buffer (see ChunkMeshArena) and the
+    // draws are built by ChunkDrawCommandBuilder. The shader used with this path reads the packed
+    // vertex from location 0 like "chunk_shader", and the chunk position from the per-instance vec3
+    // attribute at location 1 (divisor 1, selected by each draw's baseInstance) instead of the model
+    // uniform. See shaders/chunk_batch_shader.vert.
+    //
+    // Changed meshes are streamed into the arena through a persistently mapped staging buffer,
+    // one region per frame in flight (see ChunkUploadQueue). At most the upload budget is copied
+    // per frame; chunks waiting for their upload keep drawing their previous mesh.
+    // Only used from the render thread.
+    class ChunkBatchRenderer
+    {
+    public:
+        static constexpr uint32_t DEFAULT_UPLOAD_BUDGET = 4 * 1024 * 1024;
+
+        // Whether the library was built against OpenGL and the context has multi draw indirect
+        // and persistent buffer mapping. Turns false if mapping the staging buffer ever fails.
+        static bool IsSupported();
+
+        explicit ChunkBatchRenderer(uint32_t uploadBudget = DEFAULT_UPLOAD_BUDGET);
+        ~ChunkBatchRenderer();
+
+        void BeginFrame();
+        // Queue the chunk for this frame's draw, and its mesh for upload if it changed
+        void AddChunk(ChunkRenderer& chunk);
+        // Give the chunk's arena range back. Must be called before the chunk renderer is destroyed.
+        void RemoveChunk(const ChunkRenderer* chunk);
+        // Upload what fits in this frame's budget, then draw every queued chunk
+        void Draw();
+
+    private:
+        struct ChunkAllocation
+        {
+            glm::ivec3 chunkId = { 0, 0, 0 };
+            uint32_t offset = 0;
+            uint32_t capacity = 0;
+            uint32_t quadCount = 0;
+            // Latest mesh waiting in the upload queue
+            std::vector<ChunkRenderer::ChunkVertex> pendingVertices;
+        };
+
+        // Returns false if the buffers couldn't be created, nothing is left allocated then
+        bool CreateBuffers();
+        void ReleaseBuffers();
+        void GrowVertexBuffer(uint32_t capacity);
+        void UploadPendingMeshes();
+        void UploadMesh(ChunkAllocation& allocation, const ChunkUploadQueue::Upload& upload);
+
+        ChunkMeshArena m_arena;
+        ChunkDrawCommandBuilder m_commands;
+        ChunkUploadQueue m_uploadQueue;
+        std::unordered_map<const ChunkRenderer*, ChunkAllocation> m_allocations;
+        // Chunks queued for this frame's draw
+        std::vector<const ChunkAllocation*> m_frameChunks;
+
+        uint32_t m_vao = 0;
+        uint32_t m_vertexBuffer = 0;
+        uint32_t m_stagingBuffer = 0;
+        // Persistently mapped staging buffer, one region per frame in flight
+        uint8_t* m_stagingData = nullptr;
+        uint32_t m_chunkOffsetBuffer = 0;
+        uint32_t m_commandBuffer = 0;
+    };
+}
@@ -3,6 +3,8 @@
 #include <wv/core.h>
 #include <wv/voxel_worlds/BlockRegistry.h>
 #include <wv/voxel_worlds/ChunkDefines.h>
+#include <wv/voxel_worlds/PalettedBlockStorage.h>
+#include <wv/voxel_worlds/PackedLightStorage.h>
 #include <cassert>
 #include <algorithm>
 
@@ -10,11 +12,10 @@ namespace WillowVox
 {
     struct ChunkData
     {
+        // Chunks start out uniformly air and dark; no per-voxel arrays are allocated until needed
         ChunkData(const glm::ivec3& id)
             : id(id)
-        {
-            Clear();
-        }
+        {}
 
         static constexpr bool InBounds(int x, int y, int z) noexcept
         {
@@ -28,43 +29,115 @@ namespace WillowVox
             return y + CHUNK_SIZE * (x + CHUNK_SIZE * z);
         }
 
-        constexpr bool IsEmpty() noexcept
+        inline bool IsEmpty() const noexcept
+        {
+            return m_solidCount.load(std::memory_order_relaxed) == 0;
+        }
+
+        inline int GetSolidCount() const noexcept
         {
-            for (int i = 0; i < CHUNK_VOLUME; ++i)
-            {
-                if (voxels[i] != 0)
-                    return false;
-            }
-            return true;
+            return m_solidCount.load(std::memory_order_relaxed);
         }
 
         inline BlockId Get(int x, int y, int z) const noexcept
         {
             assert(InBounds(x, y, z));
-            return voxels[Index(x, y, z)];
+            return m_voxels.Get(Index(x, y, z));
         }
 
-        inline void Set(int x, int y, int z, BlockId value) noexcept
+        inline void Set(int x, int y, int z, BlockId value)
         {
             assert(InBounds(x, y, z));
-            voxels[Index(x, y, z)] = value;
+            int index = Index(x, y, z);
+            BlockId oldValue = m_voxels.Get(index);
+            if (oldValue == value)
+                return;
+
+            m_voxels.Set(index, value);
+            m_modified.store(true, std::memory_order_relaxed);
+            if (oldValue == 0)
+                m_solidCount.fetch_add(1, std::memory_order_relaxed);
+            else if (value == 0)
+                m_solidCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        // Make room for this many distinct block ids before writing them, see FillAirRun
+        inline void ReserveBlockPalette(size_t paletteSize)
+        {
+            m_voxels.Reserve(paletteSize);
+        }
+
+        // Set count voxels starting at index (in Index order) that are known to be air
+        // Writes whole runs at once, used when decoding chunks. Unlike Set this can't run
+        // alongside other writers.
+        inline void FillAirRun(int index, int count, BlockId value)
+        {
+            if (value == 0)
+                return;
+
+            m_voxels.SetRange(index, count, value);
+            m_solidCount.store(m_solidCount.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+            m_modified.store(true, std::memory_order_relaxed);
+        }
+
+        // Shrink block storage after bulk writes such as world generation
+        // Not safe to call while other threads are reading the chunk
+        inline void Compact()
+        {
+            m_voxels.Compact();
         }
 
-        inline void ClearLight() noexcept
+        // Set by block writes, cleared once the chunk is generated, loaded or saved
+        inline bool IsModified() const noexcept
         {
-            for (auto& v : lightLevels)
-                v = 0;
-            for (auto& v : skyLightLevels)
-                v = 0;
+            return m_modified.load(std::memory_order_relaxed);
         }
 
-        inline void ClearBlocks() noexcept
+        inline void SetModified(bool modified) noexcept
         {
-            for (auto& v : voxels)
-                v = 0;
+            m_modified.store(modified, std::memory_order_relaxed);
         }
 
-        inline void Clear() noexcept
+        // Not safe while other threads write light, see PackedLightStorage::Fill
+        inline void ClearLight()
+        {
+            m_light.Fill(0);
+        }
+
+        // Set every voxel to the given light levels without allocating a per-voxel array
+        // Not safe while other threads write light, see PackedLightStorage::Fill
+        inline void FillLight(int lightLevel, int skyLightLevel)
+        {
+            m_light.Fill(PackedLightStorage::Pack(lightLevel, skyLightLevel));
+        }
+
+        // Replace the light of every voxel with CHUNK_VOLUME packed values in Index order
+        // Not safe to call while other threads are reading the chunk
+        inline void LoadPackedLight(const uint8_t* packed)
+        {
+            m_light.Load(packed);
+        }
+
+        inline bool IsLightUniform() const noexcept
+        {
+            return m_light.IsUniform();
+        }
+
+        inline void ClearBlocks()
+        {
+            FillBlocks(0);
+        }
+
+        // Set every voxel to the given block without allocating per-voxel storage
+        // Not safe to call while other threads are reading the chunk
+        inline void FillBlocks(BlockId value)
+        {
+            m_voxels.Fill(value);
+            m_solidCount.store(value != 0 ? CHUNK_VOLUME : 0, std::memory_order_relaxed);
+            m_modified.store(true, std::memory_order_relaxed);
+        }
+
+        inline void Clear()
         {
             ClearBlocks();
             ClearLight();
@@ -73,31 +146,40 @@ namespace WillowVox
         inline int GetLightLevel(int x, int y, int z) const noexcept
         {
             assert(InBounds(x, y, z));
-            return lightLevels[Index(x, y, z)];
+            return m_light.GetLightLevel(Index(x, y, z));
         }
 
-        inline void SetLightLevel(int x, int y, int z, int value) noexcept
+        inline void SetLightLevel(int x, int y, int z, int value)
         {
             assert(InBounds(x, y, z));
-            lightLevels[Index(x, y, z)] = value;
+            m_light.SetLightLevel(Index(x, y, z), value);
         }
 
-        inline int GetSkyLightLevel(int x, int y, int z) const noexcept
+        // Both light levels packed as (skyLightLevel << 4) | lightLevel
+        inline uint8_t GetPackedLight(int x, int y, int z) const noexcept
         {
             assert(InBounds(x, y, z));
-            return skyLightLevels[Index(x, y, z)];
+            return m_light.GetPacked(Index(x, y, z));
         }
 
-        inline void SetSkyLightLevel(int x, int y, int z, int value) noexcept
+        inline int GetSkyLightLevel(int x, int y, int z) const noexcept
         {
             assert(InBounds(x, y, z));
-            skyLightLevels[Index(x, y, z)] = value;
+            return m_light.GetSkyLightLevel(Index(x, y, z));
         }
 
-        BlockId voxels[CHUNK_VOLUME];
-        int lightLevels[CHUNK_VOLUME];
-        int skyLightLevels[CHUNK_VOLUME];
+        inline void SetSkyLightLevel(int x, int y, int z, int value)
+        {
+            assert(InBounds(x, y, z));
+            m_light.SetSkyLightLevel(Index(x, y, z), value);
+        }
 
         glm::ivec3 id;
+
+    private:
+        PalettedBlockStorage m_voxels;
+        PackedLightStorage m_light;
+        std::atomic<int> m_solidCount = 0;
+        std::atomic<bool> m_modified = false;
     };
 }
\ No newline at end of file
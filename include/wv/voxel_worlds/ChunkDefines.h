@@ -4,4 +4,5 @@
 
 constexpr int CHUNK_SIZE = 32;
 constexpr int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+constexpr int MAX_LIGHT_LEVEL = 15;
 using BlockId = uint32_t;
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <wv/voxel_worlds/ChunkDefines.h>
+#include <vector>
+
+namespace WillowVox
+{
+    // Builds the indirect draw commands for one multi draw call over the chunk mesh arena
+    // Every draw uses the shared quad index pattern from index 0 and points at its mesh with
+    // baseVertex. baseInstance is the draw's index into the chunk offset list, which is bound as a
+    // per-instance attribute, so the shader gets each chunk's position without a uniform.
+    class ChunkDrawCommandBuilder
+    {
+    public:
+        // Same layout as OpenGL's DrawElementsIndirectCommand
+        struct DrawCommand
+        {
+            uint32_t count;
+            uint32_t instanceCount;
+            uint32_t firstIndex;
+            int32_t baseVertex;
+            uint32_t baseInstance;
+        };
+        static_assert(sizeof(DrawCommand) == 20);
+
+        void Clear();
+
+        // Add a draw for a chunk mesh of quadCount quads starting at vertexOffset in the arena
+        void AddChunk(const glm::ivec3& chunkId, uint32_t vertexOffset, uint32_t quadCount);
+
+        const std::vector<DrawCommand>& GetCommands() const { return m_commands; }
+        // World position of each draw's chunk, indexed by baseInstance
+        const std::vector<glm::vec3>& GetChunkOffsets() const { return m_chunkOffsets; }
+        // Largest quad count of any draw, the shared index buffer must cover at least this many quads
+        uint32_t GetMaxQuadCount() const { return m_maxQuadCount; }
+        bool Empty() const { return m_commands.empty(); }
+
+    private:
+        std::vector<DrawCommand> m_commands;
+        std::vector<glm::vec3> m_chunkOffsets;
+        uint32_t m_maxQuadCount = 0;
+    };
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <wv/voxel_worlds/ChunkData.h>
+#include <unordered_map>
+#include <vector>
+
+namespace WillowVox
+{
+    // Block edit of one voxel, index is in ChunkData::Index order
+    struct BlockEdit
+    {
+        uint16_t index;
+        BlockId oldId;
+        BlockId newId;
+        uint64_t tick;
+    };
+
+    // Edits made to one chunk that haven't been passed on yet
+    // Edits of the same voxel are merged until they are drained: the first old id is kept with the
+    // latest new id and tick, and a voxel that ends up back at its old id drops out entirely. A
+    // follower therefore gets at most one edit per voxel no matter how often it changed.
+    // Not thread safe.
+    class ChunkEditJournal
+    {
+    public:
+        void Record(int index, BlockId oldId, BlockId newId, uint64_t tick);
+
+        // Append the pending edits to out in the order their voxels were first edited, and clear them
+        void Drain(std::vector<BlockEdit>& out);
+
+        bool Empty() const { return m_voxelEdits.empty(); }
+        size_t Size() const { return m_voxelEdits.size(); }
+
+        // Replay drained edits on another copy of the chunk
+        static void Apply(ChunkData& chunkData, const std::vector<BlockEdit>& edits);
+
+    private:
+        // Merged away edits stay in place with oldId == newId and are skipped when draining
+        std::vector<BlockEdit> m_edits;
+        // Position in m_edits of every voxel's pending edit
+        std::unordered_map<uint16_t, uint32_t> m_voxelEdits;
+    };
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <wv/wvpch.h>
+#include <shared_mutex>
+#include <mutex>
+
+namespace WillowVox
+{
+    // Dense toroidal grid of chunk slots around a center chunk
+    // A chunk id maps to the slot at (id mod grid size) on each axis, so lookups are a few integer
+    // operations with no hashing. Only ids inside the window around the center can be stored, and
+    // moving the window drops the chunks that fell out of it.
+    //
+    // Slots are guarded by 64 lock stripes chosen from the low bits of the chunk id, so neighboring
+    // chunks never share a stripe. Recentering and iteration lock every stripe.
+    template<typename T>
+    class ChunkGrid
+    {
+    public:
+        static constexpr int STRIPE_COUNT = 64;
+
+        T Get(const glm::ivec3& id) const
+        {
+            std::shared_lock<std::shared_mutex> lock(GetStripe(id));
+            const Slot* slot = FindSlot(id);
+            return slot ? slot->value : T();
+        }
+
+        bool Contains(const glm::ivec3& id) const
+        {
+            std::shared_lock<std::shared_mutex> lock(GetStripe(id));
+            return FindSlot(id) != nullptr;
+        }
+
+        // Returns false if the id is outside the window
+        bool Set(const glm::ivec3& id, T value)
+        {
+            return SetIf(id, std::move(value), [] { return true; });
+        }
+
+        // Set the value only if the predicate still holds while the slot is locked
+        template<typename Predicate>
+        bool SetIf(const glm::ivec3& id, T value, Predicate predicate)
+        {
+            std::unique_lock<std::shared_mutex> lock(GetStripe(id));
+            if (!InWindow(id) || !predicate())
+                return false;
+
+            Slot& slot = m_slots[GetSlotIndex(id)];
+            slot.id = id;
+            slot.used = true;
+            slot.value = std::move(value);
+            return true;
+        }
+
+        bool Erase(const glm::ivec3& id)
+        {
+            std::unique_lock<std::shared_mutex> lock(GetStripe(id));
+            Slot* slot = const_cast<Slot*>(FindSlot(id));
+            if (!slot)
+                return false;
+
+            slot->used = false;
+            slot->value = T();
+            return true;
+        }
+
+        // Visit every stored chunk. The callback must not modify this grid.
+        template<typename Func>
+        void ForEach(Func func) const
+        {
+            AllStripesLock<std::shared_lock<std::shared_mutex>> lock(m_stripes);
+            for (auto& slot : m_slots)
+            {
+                if (slot.used)
+                    func(slot.id, slot.value);
+            }
+        }
+
+        size_t Size() const
+        {
+            size_t size = 0;
+            ForEach([&](const glm::ivec3&, const T&) { size++; });
+            return size;
+        }
+
+        // Move the window to cover center +/- halfExtents on each axis
+        // Chunks that end up outside the window are removed and appended to evicted if given
+        void Recenter(const glm::ivec3& center, const glm::ivec3& halfExtents, std::vector<T>* evicted = nullptr)
+        {
+            AllStripesLock<std::unique_lock<std::shared_mutex>> lock(m_stripes);
+
+            glm::ivec3 size = halfExtents * 2 + 1;
+            bool resized = size != m_size;
+
+            std::vector<Slot> oldSlots;
+            if (resized)
+            {
+                oldSlots = std::move(m_slots);
+                m_slots.assign((size_t)size.x * size.y * size.z, Slot());
+                m_size = size;
+            }
+
+            m_center = center;
+            m_halfExtents = halfExtents;
+            m_hasWindow = true;
+
+            // The slot of an id doesn't depend on the center, so unless the grid was resized only
+            // the chunks that left the window need to be touched
+            if (resized)
+            {
+                for (auto& slot : oldSlots)
+                {
+                    if (!slot.used)
+                        continue;
+
+                    if (InWindow(slot.id))
+                        m_slots[GetSlotIndex(slot.id)] = std::move(slot);
+                    else if (evicted)
+                        evicted->push_back(std::move(slot.value));
+                }
+            }
+            else
+            {
+                for (auto& slot : m_slots)
+                {
+                    if (!slot.used || InWindow(slot.id))
+                        continue;
+
+                    if (evicted)
+                        evicted->push_back(std::move(slot.value));
+                    slot = Slot();
+                }
+            }
+        }
+
+        bool InWindow(const glm::ivec3& id) const
+        {
+            glm::ivec3 offset = glm::abs(id - m_center);
+            return m_hasWindow && offset.x <= m_halfExtents.x && offset.y <= m_halfExtents.y && offset.z <= m_halfExtents.z;
+        }
+
+    private:
+        struct Slot
+        {
+            glm::ivec3 id = { 0, 0, 0 };
+            bool used = false;
+            T value = T();
+        };
+
+        struct alignas(64) Stripe
+        {
+            mutable std::shared_mutex mutex;
+        };
+
+        // Locks every stripe in order for the lifetime of the object
+        template<typename Lock>
+        struct AllStripesLock
+        {
+            AllStripesLock(const Stripe* stripes)
+            {
+                for (int i = 0; i < STRIPE_COUNT; i++)
+                    locks[i] = Lock(stripes[i].mutex);
+            }
+
+            Lock locks[STRIPE_COUNT];
+        };
+
+        std::shared_mutex& GetStripe(const glm::ivec3& id) const
+        {
+            return m_stripes[(id.x & 3) | (id.y & 3) << 2 | (id.z & 3) << 4].mutex;
+        }
+
+        static int Wrap(int value, int size)
+        {
+            int wrapped = value % size;
+            return wrapped < 0 ? wrapped + size : wrapped;
+        }
+
+        size_t GetSlotIndex(const glm::ivec3& id) const
+        {
+            return Wrap(id.y, m_size.y) + (size_t)m_size.y * (Wrap(id.x, m_size.x) + (size_t)m_size.x * Wrap(id.z, m_size.z));
+        }
+
+        const Slot* FindSlot(const glm::ivec3& id) const
+        {
+            if (!InWindow(id))
+                return nullptr;
+
+            const Slot& slot = m_slots[GetSlotIndex(id)];
+            return slot.used && slot.id == id ? &slot : nullptr;
+        }
+
+        Stripe m_stripes[STRIPE_COUNT];
+
+        bool m_hasWindow = false;
+        glm::ivec3 m_center = { 0, 0, 0 };
+        glm::ivec3 m_halfExtents = { 0, 0, 0 };
+        glm::ivec3 m_size = { 0, 0, 0 };
+        std::vector<Slot> m_slots;
+    };
+}
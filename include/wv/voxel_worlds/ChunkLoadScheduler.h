@@ -0,0 +1,73 @@
+#pragma once
+
+#include <wv/voxel_worlds/ChunkDefines.h>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include <unordered_set>
+#include <vector>
+
+namespace WillowVox
+{
+    // Orders the chunks waiting to be loaded around the camera
+    // Chunks closer to the camera chunk come first, and chunks in front of the camera come before
+    // chunks behind it at the same distance. Every chunk id is queued at most once.
+    //
+    // Moving the center only adds the chunks that entered the range, and chunks that left it are
+    // dropped when they reach the top of the queue. Priorities are keyed against a center that
+    // trails the camera by a couple of chunks, so the queue is only re-keyed when the camera has
+    // moved further than that or turned past VIEW_DIRECTION_THRESHOLD.
+    // Not thread safe, owned by the chunk thread.
+    class ChunkLoadScheduler
+    {
+    public:
+        // Smallest dot product between two view directions that still counts as the same direction
+        static constexpr float VIEW_DIRECTION_THRESHOLD = 0.966f;
+
+        // Move the load range to a new center chunk
+        // The range covers |dx| < renderDistance, |dz| < renderDistance and |dy| <= renderHeight
+        void SetCenter(const glm::ivec3& center, int renderDistance, int renderHeight);
+
+        // Set the camera view direction used to favor visible chunks
+        // Small changes are ignored so the queue isn't reordered every frame
+        void SetViewDirection(const glm::vec3& direction);
+
+        // Take the highest priority chunk, returns false when nothing is queued
+        bool Pop(glm::ivec3& outId);
+
+        // Queue a chunk again, for example after its load was cancelled
+        void Push(const glm::ivec3& id);
+
+        bool InRange(const glm::ivec3& id) const;
+        bool IsQueued(const glm::ivec3& id) const { return m_queued.contains(id) && InRange(id); }
+        // Both may still count chunks that left the range but weren't popped yet
+        bool Empty() const { return m_queued.empty(); }
+        size_t Size() const { return m_queued.size(); }
+
+    private:
+        struct Entry
+        {
+            float priority;
+            glm::ivec3 id;
+
+            // Lowest priority value on top of the heap
+            bool operator<(const Entry& other) const { return priority > other.priority; }
+        };
+
+        float GetPriority(const glm::ivec3& id) const;
+        // Drop queued chunks that left the range and key the rest again
+        void RebuildHeap();
+
+        bool m_hasCenter = false;
+        glm::ivec3 m_center = { 0, 0, 0 };
+        // Center the heap entries are keyed against
+        glm::ivec3 m_keyCenter = { 0, 0, 0 };
+        int m_renderDistance = 0;
+        int m_renderHeight = 0;
+        glm::vec3 m_viewDirection = { 0, 0, 0 };
+
+        // The heap may hold stale entries for chunks that were popped. m_queued is the
+        // authoritative set, apart from chunks that left the range.
+        std::vector<Entry> m_heap;
+        std::unordered_set<glm::ivec3> m_queued;
+    };
+}
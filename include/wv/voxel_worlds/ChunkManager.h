@@ -2,20 +2,57 @@
 
 #include <wv/voxel_worlds/WorldGen.h>
 #include <wv/voxel_worlds/ChunkRenderer.h>
+#include <wv/voxel_worlds/ChunkLoadScheduler.h>
+#include <wv/voxel_worlds/ChunkStore.h>
+#include <wv/voxel_worlds/Frustum.h>
+#include <wv/voxel_worlds/ChunkBatchRenderer.h>
+#include <wv/voxel_worlds/RegionStore.h>
+#include <wv/voxel_worlds/ChunkEditJournal.h>
+#include <wv/voxel_worlds/ChunkRemeshScheduler.h>
+#include <wv/voxel_worlds/ChunkTaskPool.h>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 #include <wv/core.h>
 #include <thread>
 #include <mutex>
 #include <shared_mutex>
+#include <condition_variable>
 #include <queue>
+#include <future>
+#include <unordered_set>
+#include <functional>
 
 namespace WillowVox
 {
     class ChunkManager
     {
     public:
-        ChunkManager(WorldGen* worldGen, int numChunkThreads, int worldSizeX = 0, int worldMinY = 0, int worldMaxY = 0, int worldSizeZ = 0);
+        struct ChunkEdits
+        {
+            glm::ivec3 chunkId;
+            std::vector<BlockEdit> edits;
+        };
+
+        struct BlockChange
+        {
+            // Block position in the world
+            glm::ivec3 pos;
+            BlockId blockId;
+        };
+
+        // Blocks copied out of a box of the world, see CopyRegion
+        // Laid out like ChunkData, y first, then x, then z
+        struct BlockRegion
+        {
+            glm::ivec3 size = { 0, 0, 0 };
+            std::vector<BlockId> blocks;
+
+            size_t Index(int x, int y, int z) const { return y + (size_t)size.y * (x + (size_t)size.x * z); }
+        };
+
+        // RingBuffer storage keeps chunks in a dense grid around the camera instead of a hash map
+        ChunkManager(WorldGen* worldGen, int numChunkThreads, int worldSizeX = 0, int worldMinY = 0, int worldMaxY = 0, int worldSizeZ = 0,
+            ChunkStorageMode storageMode = ChunkStorageMode::HashMap);
         ~ChunkManager();
 
         std::shared_ptr<ChunkData> GetChunkData(int x, int y, int z);
@@ -30,10 +67,58 @@ namespace WillowVox
 
         void SetBlockId(float x, float y, float z, BlockId blockId);
 
+        // Mesh the chunk again at the next flush, once per frame from Render
+        // Requests for the same chunk before then are merged, see ChunkRemeshScheduler
+        void RequestRemesh(const glm::ivec3& id, bool urgent = false);
+
+        // Bulk edits. Every block is written first, then lighting is updated in one pass and each
+        // affected chunk is remeshed once, instead of once per block like SetBlockId.
+        // Blocks in chunks that aren't loaded are skipped. Box corners are inclusive block positions.
+        void SetBlocks(const std::vector<BlockChange>& changes);
+        void FillBox(const glm::ivec3& min, const glm::ivec3& max, BlockId blockId);
+        // Fill the blocks whose centers are within radius of center
+        void FillSphere(const glm::vec3& center, float radius, BlockId blockId);
+        // Blocks in unloaded chunks are copied as air
+        BlockRegion CopyRegion(const glm::ivec3& min, const glm::ivec3& max);
+        // Place a copied region with its minimum corner at origin, optionally leaving blocks where the region has air
+        void PasteRegion(const BlockRegion& region, const glm::ivec3& origin, bool skipAir = false);
+
+        // Journal the block edits made through this manager so followers, such as a replica or a
+        // save thread, can replay them with ChunkEditJournal::Apply. Edits of a voxel are merged
+        // until they are drained, see ChunkEditJournal.
+        void SetEditJournalEnabled(bool enabled);
+        // Tick stamped on edits from now on, usually the simulation tick
+        void SetEditTick(uint64_t tick) { m_editTick = tick; }
+        // Move the pending edits of every chunk into out
+        void DrainEdits(std::vector<ChunkEdits>& out);
+
+        // Draw the loaded chunks inside the camera's view frustum, or every chunk without a camera
         void Render();
+        // Draw only the chunks inside the view frustum of the given projection * view matrix, for
+        // passes that don't render from the camera
+        void Render(const glm::mat4& viewProjection);
 
-        void SetCamera(Camera* camera) { m_camera = camera; }
-        void SetRenderDistance(int renderDistance, int renderHeight) { m_renderDistance = renderDistance; m_renderHeight = renderHeight; }
+        // Draw all chunks with one multi draw indirect call instead of one draw per chunk
+        // Needs OpenGL 4.4 and a "chunk_batch_shader" asset, which takes the chunk position as an
+        // instanced attribute rather than the model uniform (see ChunkBatchRenderer and
+        // shaders/README.md). Render thread only.
+        // At most uploadBudget bytes of changed meshes are uploaded per frame.
+        void SetBatchedRendering(bool enabled, uint32_t uploadBudget = ChunkBatchRenderer::DEFAULT_UPLOAD_BUDGET);
+
+        // Save modified chunks as region files in the directory when they are unloaded, and load
+        // saved chunks from it instead of generating them. Call before setting the camera, later
+        // calls are ignored.
+        void SetSaveDirectory(const std::filesystem::path& directory);
+        // Save every loaded chunk that was modified since it was loaded or last saved
+        void SaveModifiedChunks();
+
+        void SetCamera(Camera* camera);
+        // Chunks in the direction the camera faces are loaded first at the same distance
+        void SetRenderDistance(int renderDistance, int renderHeight);
+        // Mesh distant chunks at lower detail, 0 turns LOD off
+        // Chunks up to distance - 1 chunks away from the camera chunk are meshed at full detail, then
+        // the detail halves at distance, 2 * distance and 4 * distance (down to 8x8x8 blocks per cell)
+        void SetLodDistance(int distance);
 
         inline glm::ivec3 WorldToBlockPos(float x, float y, float z)
         {
@@ -80,22 +165,102 @@ namespace WillowVox
 #ifdef DEBUG_MODE
         float m_avgChunkDataGenTime = 0.0f;
         int m_chunkDataGenerated = 0;
+        // Chunks loaded from the save directory instead of generated
+        int m_chunkDataLoaded = 0;
+        // Chunks that passed culling in the last frame
+        int m_chunksRendered = 0;
 #endif
 
     private:
+        struct ChunkLoad;
+        struct BulkEdit;
+
+        // Returns nullptr outside the world bounds, or outside the ring buffer window
         std::shared_ptr<ChunkData> GetOrGenerateChunkData(const glm::ivec3& id);
+        void SaveChunkData(ChunkData& chunkData);
+        void RecordEdit(const glm::ivec3& chunkId, const glm::ivec3& localPos, BlockId oldId, BlockId newId);
+
+        // Bulk edit helpers, see SetBlocks
+        // Write the blocks chosen by getBlock in the box between min and max. getBlock returns false
+        // to leave a block unchanged.
+        void EditBlocks(const glm::ivec3& min, const glm::ivec3& max, const std::function<bool(const glm::ivec3&, BlockId&)>& getBlock);
+        // Write blocks at local positions of one chunk and add what changed to the edit
+        void WriteChunkBlocks(BulkEdit& edit, const std::shared_ptr<ChunkData>& chunk, const std::vector<BlockChange>& writes);
+        // Relight and remesh everything the edit changed in one job
+        void FinishBulkEdit(std::shared_ptr<BulkEdit> edit);
         void ChunkThread();
+        // Start mesh jobs for the requested remeshes. Urgent chunks share one job so their new
+        // meshes show up in the same frame.
+        void FlushRemeshes();
+        // Publish the camera chunk and view direction to the chunk thread if they changed. Called
+        // from the render thread.
+        void UpdateCameraChunk(bool force);
+        void WakeChunkThread();
+
+        void RenderChunks(const Frustum* frustum);
+        // Draw the chunks reachable from the camera chunk through open space, see
+        // ChunkRenderer::SetCaveCullingEnabled
+        void RenderCaveCulled(const Frustum* frustum);
+        static bool IsChunkInFrustum(const Frustum* frustum, const glm::ivec3& id);
+        void DrawChunk(ChunkRenderer& chunk);
+
+        static int GetChunkLod(const glm::ivec3& id, const glm::ivec3& center, int lodDistance);
+        // Set the chunk's LOD level and seam faces for the camera chunk, returns true if they changed
+        static bool UpdateChunkLod(ChunkRenderer& chunk, const glm::ivec3& center, int lodDistance);
+        // Remesh the loaded chunks whose LOD changed. Chunk thread only.
+        void UpdateChunkLods(const glm::ivec3& center, int lodDistance);
+
+        // Chunk loading pipeline. Each stage runs as a task on the chunk thread pool:
+        // generate the chunk and its neighbors in parallel, then light it, then mesh it
+        void StartChunkLoad(const glm::ivec3& id);
+        void LightChunkLoad(std::shared_ptr<ChunkLoad> load);
+        void MeshChunkLoad(std::shared_ptr<ChunkLoad> load);
+        void FinishChunkLoad(const ChunkLoad& load);
 
         WorldGen* m_worldGen;
 
         Camera* m_camera = nullptr;
-        int m_renderDistance, m_renderHeight;
-        std::queue<glm::ivec3> m_chunkQueue;
+        glm::ivec3 m_lastCameraChunk = { 0, 0, 0 };
+        glm::vec3 m_lastViewDirection = { 0, 0, 0 };
+
+        // Cave culling search state, reused every frame by the render thread
+        struct VisibilityStep
+        {
+            glm::ivec3 id;
+            int entryFace;
+            // Faces the search has already stepped through on the way here
+            uint8_t directions;
+        };
+        std::vector<VisibilityStep> m_visibilitySearch;
+        std::vector<bool> m_visitedChunks;
+
+        // State shared with the chunk thread, guarded by m_chunkThreadMutex
+        glm::ivec3 m_cameraChunk = { 0, 0, 0 };
+        bool m_hasCameraChunk = false;
+        int m_renderDistance = 0, m_renderHeight = 0;
+        glm::vec3 m_viewDirection = { 0, 0, 0 };
+        int m_lodDistance = 0;
+        bool m_chunkThreadWake = false;
 
-        std::unordered_map<glm::ivec3, std::shared_ptr<ChunkData>> m_chunkData;
-        std::shared_mutex m_chunkDataMutex;
-        std::unordered_map <glm::ivec3, std::shared_ptr<ChunkRenderer>> m_chunkRenderers;
-        std::shared_mutex m_chunkRendererMutex;
+        ChunkLoadScheduler m_loadScheduler;
+
+        ChunkStore<std::shared_ptr<ChunkData>> m_chunkData;
+        // Chunk data currently being generated, so concurrent loads share one generation
+        std::unordered_map<glm::ivec3, std::shared_future<std::shared_ptr<ChunkData>>> m_pendingChunkData;
+        std::mutex m_pendingChunkDataMutex;
+        ChunkStore<std::shared_ptr<ChunkRenderer>> m_chunkRenderers;
+
+        // Set while chunks are saved
+        std::unique_ptr<RegionStore> m_regionStore;
+
+        std::atomic<bool> m_editJournalEnabled = false;
+        std::atomic<uint64_t> m_editTick = 0;
+        std::unordered_map<glm::ivec3, ChunkEditJournal> m_editJournals;
+        std::mutex m_editJournalMutex;
+
+        ChunkRemeshScheduler m_remeshScheduler;
+        // Reused by FlushRemeshes
+        std::vector<glm::ivec3> m_urgentRemeshes, m_backgroundRemeshes;
 
         std::queue<std::shared_ptr<ChunkRenderer>> m_chunkRendererDeletionQueue;
         std::mutex m_chunkRendererDeletionMutex;
@@ -105,9 +270,20 @@ namespace WillowVox
         std::shared_ptr<Shader> m_chunkShader;
         std::shared_ptr<Texture> m_chunkTexture;
 
+        // Set while batched rendering is on
+        std::unique_ptr<ChunkBatchRenderer> m_batchRenderer;
+        std::shared_ptr<Shader> m_chunkBatchShader;
+
+        // Chunks with a load in the pipeline. Their data and neighbor data are not evicted.
+        std::unordered_map<glm::ivec3, std::shared_ptr<ChunkLoad>> m_loadingChunks;
+        std::mutex m_loadingChunksMutex;
+        int m_maxChunksInFlight;
+
         std::thread m_chunkThread;
-        bool m_chunkThreadShouldStop = false;
+        std::atomic<bool> m_chunkThreadShouldStop = false;
+        std::mutex m_chunkThreadMutex;
+        std::condition_variable m_chunkThreadCondition;
 
-        ThreadPool m_chunkThreadPool;
+        ChunkTaskPool m_chunkThreadPool;
     };
 }
\ No newline at end of file
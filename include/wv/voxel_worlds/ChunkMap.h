@@ -0,0 +1,117 @@
+#pragma once
+
+#include <wv/wvpch.h>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace WillowVox
+{
+    // Hash for chunk ids that mixes all three axes, so neighboring chunks spread across shards
+    struct ChunkIdHash
+    {
+        size_t operator()(const glm::ivec3& id) const noexcept
+        {
+            uint64_t hash = (uint64_t)(uint32_t)id.x * 0x9E3779B97F4A7C15ull;
+            hash ^= (uint64_t)(uint32_t)id.y * 0xC2B2AE3D27D4EB4Full;
+            hash ^= (uint64_t)(uint32_t)id.z * 0x165667B19E3779F9ull;
+            return (size_t)(hash ^ (hash >> 29));
+        }
+    };
+
+    // Concurrent map from chunk id to a value, split into independently locked shards
+    // Lookups only lock the shard owning the id and probe its table once, so readers on different
+    // chunks don't contend on a single lock. Values are returned by copy (usually a shared_ptr).
+    template<typename T>
+    class ChunkMap
+    {
+    public:
+        static constexpr int SHARD_BITS = 6;
+        static constexpr int SHARD_COUNT = 1 << SHARD_BITS;
+
+        // Value for the id, or a default constructed value if it isn't in the map
+        T Get(const glm::ivec3& id) const
+        {
+            size_t hash = ChunkIdHash()(id);
+            auto& shard = GetShard(hash);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.map.find(id);
+            return it != shard.map.end() ? it->second : T();
+        }
+
+        bool Contains(const glm::ivec3& id) const
+        {
+            size_t hash = ChunkIdHash()(id);
+            auto& shard = GetShard(hash);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            return shard.map.contains(id);
+        }
+
+        void Set(const glm::ivec3& id, T value)
+        {
+            size_t hash = ChunkIdHash()(id);
+            auto& shard = GetShard(hash);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.map.insert_or_assign(id, std::move(value));
+        }
+
+        // Set the value only if the predicate still holds while the shard is locked
+        template<typename Predicate>
+        bool SetIf(const glm::ivec3& id, T value, Predicate predicate)
+        {
+            size_t hash = ChunkIdHash()(id);
+            auto& shard = GetShard(hash);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            if (!predicate())
+                return false;
+
+            shard.map.insert_or_assign(id, std::move(value));
+            return true;
+        }
+
+        bool Erase(const glm::ivec3& id)
+        {
+            size_t hash = ChunkIdHash()(id);
+            auto& shard = GetShard(hash);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            return shard.map.erase(id) > 0;
+        }
+
+        // Visit every entry. Each shard is locked for reading while it is visited, so the callback
+        // must not modify this map.
+        template<typename Func>
+        void ForEach(Func func) const
+        {
+            for (auto& shard : m_shards)
+            {
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                for (auto& [id, value] : shard.map)
+                    func(id, value);
+            }
+        }
+
+        size_t Size() const
+        {
+            size_t size = 0;
+            for (auto& shard : m_shards)
+            {
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                size += shard.map.size();
+            }
+            return size;
+        }
+
+    private:
+        // Padded to a cache line so shards locked by different threads don't share one
+        struct alignas(64) Shard
+        {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<glm::ivec3, T, ChunkIdHash> map;
+        };
+
+        // The top bits pick the shard, the table uses the low bits
+        Shard& GetShard(size_t hash) { return m_shards[hash >> (sizeof(size_t) * 8 - SHARD_BITS)]; }
+        const Shard& GetShard(size_t hash) const { return m_shards[hash >> (sizeof(size_t) * 8 - SHARD_BITS)]; }
+
+        Shard m_shards[SHARD_COUNT];
+    };
+}
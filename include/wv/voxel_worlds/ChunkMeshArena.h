@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace WillowVox
+{
+    // Allocator for ranges of one large vertex buffer shared by every chunk mesh
+    // Only tracks offsets and sizes (in vertices); the buffer itself is owned by the caller.
+    // Free ranges are kept sorted by offset and merged with their neighbors when freed.
+    class ChunkMeshArena
+    {
+    public:
+        explicit ChunkMeshArena(uint32_t capacity = 0);
+
+        // Reserve size vertices from the first free range that fits
+        // Returns false if no free range is large enough, the caller can Grow and retry
+        bool Allocate(uint32_t size, uint32_t& outOffset);
+        void Free(uint32_t offset, uint32_t size);
+
+        // Extend the arena to a larger capacity, existing allocations keep their offsets
+        void Grow(uint32_t capacity);
+
+        uint32_t GetCapacity() const { return m_capacity; }
+        uint32_t GetUsed() const { return m_used; }
+        size_t GetFreeRangeCount() const { return m_freeRanges.size(); }
+        uint32_t GetLargestFreeRange() const;
+
+    private:
+        void InsertFreeRange(uint32_t offset, uint32_t size);
+
+        // Offset -> size
+        std::map<uint32_t, uint32_t> m_freeRanges;
+        uint32_t m_capacity = 0;
+        uint32_t m_used = 0;
+    };
+}
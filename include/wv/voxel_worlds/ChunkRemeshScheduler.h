@@ -0,0 +1,31 @@
+#pragma once
+
+#include <wv/voxel_worlds/ChunkDefines.h>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+
+namespace WillowVox
+{
+    // Collects the chunks that need a new mesh until they are flushed, usually once per frame
+    // Edits, lighting updates, neighbor loads and LOD changes ask for remeshes here instead of
+    // meshing inline, so a chunk asked for several times before the flush is only meshed once.
+    // Thread safe.
+    class ChunkRemeshScheduler
+    {
+    public:
+        // Urgent chunks, such as the ones touched by an edit, are meshed together ahead of other work
+        void Request(const glm::ivec3& id, bool urgent = false);
+
+        // Move the requested chunk ids out, split by urgency
+        // A chunk requested both ways only ends up in outUrgent
+        void Take(std::vector<glm::ivec3>& outUrgent, std::vector<glm::ivec3>& outBackground);
+
+    private:
+        // Chunk id to whether any of its requests was urgent
+        std::unordered_map<glm::ivec3, bool> m_requests;
+        std::mutex m_mutex;
+    };
+}
@@ -8,15 +8,44 @@ namespace WillowVox
     class ChunkRenderer
     {
     public:
+        // Packed 8 byte chunk vertex, read by the shader as a single ivec2 attribute
+        // data0: x (6 bits) | y (6) | z (6) | face (3) | corner (2) | light level (4) | sky light level (4)
+        // data1: atlas tile (16 bits) | log2 atlas width in tiles (4) | log2 atlas height in tiles (4)
+        // Positions are in blocks from the chunk origin (0-32). Faces are ordered south (+Z), north (-Z),
+        // east (+X), west (-X), up, down. The shader derives texture coordinates from the position along
+        // the face's axes, so textures repeat across greedy quads. shaders/chunk_shader.vert is a
+        // reference decoder and shaders/README.md covers porting shaders from the old format.
         struct ChunkVertex
         {
-            glm::vec3 pos;
-            glm::vec3 normal;
-            glm::vec2 texPos;
-            int lightLevel;
-            int skylightLevel;
+            uint32_t data0;
+            uint32_t data1;
+
+            static constexpr ChunkVertex Pack(int x, int y, int z, int face, int corner, uint8_t packedLight, int texIndex, uint32_t atlasBits)
+            {
+                return {
+                    (uint32_t)x | (uint32_t)y << 6 | (uint32_t)z << 12 | (uint32_t)face << 18 | (uint32_t)corner << 21 | (uint32_t)packedLight << 23,
+                    (uint32_t)texIndex | atlasBits << 16
+                };
+            }
+        };
+        static_assert(sizeof(ChunkVertex) == 8);
+
+        enum class MeshingMode
+        {
+            Simple, // One quad per exposed face
+            Greedy  // Merge coplanar faces with the same block and light into larger quads
         };
 
+        static void SetMeshingMode(MeshingMode mode) { s_meshingMode = mode; }
+        static MeshingMode GetMeshingMode() { return s_meshingMode; }
+
+        // Build a face-to-face visibility graph for every meshed chunk, used for cave culling
+        // Chunks meshed while this was off count as fully connected
+        static void SetCaveCullingEnabled(bool enabled) { s_caveCulling = enabled; }
+        static bool IsCaveCullingEnabled() { return s_caveCulling; }
+
+        static constexpr int MAX_LOD = 3;
+
         ChunkRenderer(std::shared_ptr<ChunkData> chunkData, const glm::ivec3& chunkId);
         ~ChunkRenderer();
 
@@ -27,11 +56,31 @@ namespace WillowVox
         void SetUpData(std::shared_ptr<ChunkData> data) { m_upChunkData = data; }
         void SetDownData(std::shared_ptr<ChunkData> data) { m_downChunkData = data; }
 
+        // Upload the mesh if it changed and draw it. Chunks with an empty mesh draw nothing.
         void Render();
+        // Copy the mesh out if it changed since it was last drawn, for renderers that draw it elsewhere
+        bool CopyMeshIfDirty(std::vector<ChunkVertex>& vertices);
+
+        // Every quad is drawn with the same 0, 2, 1, 1, 2, 3 pattern, so all chunks share one
+        // GL_ELEMENT_ARRAY_BUFFER. Returns it grown to cover at least quadCount quads; it is only
+        // re-uploaded when it grows and keeps its name, so vaos that bound it stay valid.
+        // Only used from the render thread.
+        static uint32_t GetQuadIndexBuffer(size_t quadCount);
 
         void GenerateMesh(uint32_t currentVersion = 0, bool batch = false);
         void MarkDirty() { m_dirty = true; }
 
+        // Whether open space inside the chunk connects two of its faces, using the vertex face order
+        bool ConnectsFaces(int from, int to) const { return m_faceConnectivity >> (from * 6 + to) & 1; }
+
+        // Mesh the chunk downsampled 2^level times (up to 8x) from the next mesh on
+        // seamFaces has a bit per face (vertex face order) whose neighbor uses a different level.
+        // Faces on those borders are never culled against the neighbor, which closes the gaps
+        // between the two levels.
+        void SetLod(int level, uint8_t seamFaces) { m_lod = (uint16_t)(level | seamFaces << 8); }
+        int GetLod() const { return m_lod & 0xFF; }
+        uint8_t GetLodSeams() const { return (uint8_t)(m_lod >> 8); }
+
 #ifdef DEBUG_MODE
         static float m_avgMeshGenTime;
         static int m_meshesGenerated;
@@ -44,10 +93,34 @@ namespace WillowVox
         std::mutex m_meshDataMutex;
 
         std::atomic<uint32_t> m_version = 0;
+        // Set while a mesh job for the chunk is queued and hasn't started meshing it yet
+        // Jobs that find it cleared skip the chunk, another job already meshed it
+        std::atomic<bool> m_remeshQueued = false;
 
     private:
+        struct PaddedChunkVolume;
+
+        void FillPaddedVolume(PaddedChunkVolume& volume, uint8_t seamFaces) const;
+        // Fill cells [0, CHUNK_SIZE >> level) of the volume with the chunk downsampled 2^level times
+        void FillDownsampledVolume(PaddedChunkVolume& volume, int level, uint8_t seamFaces) const;
+        // Compute the visible face bitmasks of the volume, returns false when no face is visible
+        bool BuildFaceMasks(PaddedChunkVolume& volume) const;
+        // Drop the faces outside the first size cells on each axis, returns false when none are left
+        static bool ClipFaceMasks(PaddedChunkVolume& volume, int size);
+        bool GenerateSimpleMesh(const PaddedChunkVolume& volume, std::vector<ChunkVertex>& vertices, uint32_t currentVersion);
+        bool GenerateGreedyMesh(const PaddedChunkVolume& volume, std::vector<ChunkVertex>& vertices, uint32_t currentVersion);
+        // Flood fill the open space of the volume and return which faces each region touches
+        static uint64_t BuildFaceConnectivity(const PaddedChunkVolume& volume);
+
+        static constexpr uint64_t ALL_FACES_CONNECTED = (1ull << 36) - 1;
+
+        static std::atomic<MeshingMode> s_meshingMode;
+        static std::atomic<bool> s_caveCulling;
+
         std::shared_ptr<ChunkData> m_chunkData;
-        std::unique_ptr<VertexArrayObject> m_vao;
+        // The chunk's own vertex buffer, drawn with the shared quad index buffer
+        uint32_t m_vao = 0;
+        uint32_t m_vertexBuffer = 0;
 
         std::shared_ptr<ChunkData> m_northChunkData = nullptr;
         std::shared_ptr<ChunkData> m_southChunkData = nullptr;
@@ -59,7 +132,14 @@ namespace WillowVox
         std::shared_ptr<Shader> m_chunkShader;
 
         std::vector<ChunkVertex> m_vertices;
-        std::vector<int> m_indices;
-        bool m_dirty = true;
+        // Size of the last generated mesh, used to reserve the next one
+        size_t m_lastVertexCount = 0;
+        // Number of quads in the uploaded mesh
+        size_t m_uploadedQuadCount = 0;
+        std::atomic<bool> m_dirty = true;
+        // Bit from * 6 + to is set when the faces are connected, all faces connect until meshed
+        std::atomic<uint64_t> m_faceConnectivity = ALL_FACES_CONNECTED;
+        // LOD level in the low byte, seam faces in the high byte
+        std::atomic<uint16_t> m_lod = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <wv/voxel_worlds/ChunkData.h>
+#include <vector>
+
+namespace WillowVox
+{
+    // Binary encoding of a chunk, used for saving and for sending chunks between processes
+    // A 24-byte header (magic, version, flags, chunk id and body size) is followed by the body:
+    // the chunk's block palette, the blocks as runs of (length, palette index) in ChunkData::Index
+    // order, then optionally the packed light as runs of (length, packed value). Numbers in the body
+    // are variable length integers, so a column of stone under air only takes a few bytes. The body
+    // can then be LZ compressed, which folds the columns that repeat the same runs.
+    //
+    // All numbers are stored little endian.
+    namespace ChunkSerializer
+    {
+        constexpr uint32_t MAGIC = 0x4B435657; // "WVCK"
+        constexpr uint8_t VERSION = 1;
+        constexpr size_t HEADER_SIZE = 24;
+
+        enum Flags : uint8_t
+        {
+            INCLUDE_LIGHT = 1 << 0,
+            COMPRESS = 1 << 1
+        };
+
+        // Append the encoded chunk to out
+        void Serialize(const ChunkData& chunkData, std::vector<uint8_t>& out, uint8_t flags = INCLUDE_LIGHT | COMPRESS);
+
+        // Read the chunk id from the header, returns false if the data isn't a serialized chunk
+        bool GetChunkId(const uint8_t* data, size_t size, glm::ivec3& outId);
+
+        // Replace the chunk's blocks, and its light if it was serialized, with the encoded ones
+        // The chunk id is left as it is. Returns false if the data is malformed or from a newer
+        // version, in which case the chunk is left empty.
+        bool Deserialize(const uint8_t* data, size_t size, ChunkData& chunkData);
+    }
+}
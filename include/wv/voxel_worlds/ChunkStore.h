@@ -0,0 +1,70 @@
+#pragma once
+
+#include <wv/voxel_worlds/ChunkMap.h>
+#include <wv/voxel_worlds/ChunkGrid.h>
+
+namespace WillowVox
+{
+    enum class ChunkStorageMode
+    {
+        HashMap,   // Sharded hash map, chunks can live anywhere
+        RingBuffer // Toroidal grid around the camera, chunks outside the render window are dropped
+    };
+
+    // Chunk storage used by ChunkManager, backed by either a ChunkMap or a ChunkGrid
+    template<typename T>
+    class ChunkStore
+    {
+    public:
+        explicit ChunkStore(ChunkStorageMode mode)
+        {
+            if (mode == ChunkStorageMode::RingBuffer)
+                m_grid = std::make_unique<ChunkGrid<T>>();
+        }
+
+        bool IsRingBuffer() const { return m_grid != nullptr; }
+
+        T Get(const glm::ivec3& id) const { return m_grid ? m_grid->Get(id) : m_map.Get(id); }
+        bool Contains(const glm::ivec3& id) const { return m_grid ? m_grid->Contains(id) : m_map.Contains(id); }
+
+        // Returns false if the ring buffer window doesn't include the id, always succeeds in hash map mode
+        bool Set(const glm::ivec3& id, T value)
+        {
+            if (m_grid)
+                return m_grid->Set(id, std::move(value));
+
+            m_map.Set(id, std::move(value));
+            return true;
+        }
+
+        template<typename Predicate>
+        bool SetIf(const glm::ivec3& id, T value, Predicate predicate)
+        {
+            return m_grid ? m_grid->SetIf(id, std::move(value), predicate) : m_map.SetIf(id, std::move(value), predicate);
+        }
+
+        bool Erase(const glm::ivec3& id) { return m_grid ? m_grid->Erase(id) : m_map.Erase(id); }
+
+        template<typename Func>
+        void ForEach(Func func) const
+        {
+            if (m_grid)
+                m_grid->ForEach(func);
+            else
+                m_map.ForEach(func);
+        }
+
+        size_t Size() const { return m_grid ? m_grid->Size() : m_map.Size(); }
+
+        // Move the ring buffer window, does nothing in hash map mode
+        void Recenter(const glm::ivec3& center, const glm::ivec3& halfExtents, std::vector<T>* evicted = nullptr)
+        {
+            if (m_grid)
+                m_grid->Recenter(center, halfExtents, evicted);
+        }
+
+    private:
+        ChunkMap<T> m_map;
+        std::unique_ptr<ChunkGrid<T>> m_grid;
+    };
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <wv/core.h>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+namespace WillowVox
+{
+    // Thread pool for chunk work that counts its queued and running tasks
+    // Tasks often queue the next step of their work (load, light, mesh), so a task queued from a
+    // running task is counted before that task finishes. Drain can then wait for all of it.
+    class ChunkTaskPool
+    {
+    public:
+        void Start(int threadCount) { m_pool.Start(threadCount); }
+
+        template<typename Task>
+        void Enqueue(Task task, Priority priority)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_pendingTasks++;
+            }
+
+            m_pool.Enqueue([this, task = std::move(task)]() mutable {
+                task();
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (--m_pendingTasks == 0)
+                    m_drained.notify_all();
+            }, priority);
+        }
+
+        // Wait until every task, and every task they queued, has finished
+        // Nothing else may queue root tasks meanwhile
+        void Drain()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_drained.wait(lock, [this] { return m_pendingTasks == 0; });
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_drained;
+        int m_pendingTasks = 0;
+        // Destroyed first, so its threads are gone before the counter is
+        ThreadPool m_pool;
+    };
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace WillowVox
+{
+    // Schedules mesh uploads through a ring of staging regions with a per-frame byte budget
+    // Every frame uses the next region of the staging buffer, sized to the budget. When a frame has
+    // uploaded something it is closed with a fence, and the region is only written again once that
+    // fence has signalled, so the CPU never overwrites staging data the GPU is still copying from.
+    //
+    // Only decides what goes where; the caller owns the mesh data, the staging buffer and the fences.
+    // Uploads leave in the order they were queued. Queueing a key again replaces its size but keeps
+    // its place, so a chunk that is remeshed often isn't pushed to the back every time.
+    class ChunkUploadQueue
+    {
+    public:
+        using Key = const void*;
+
+        struct Upload
+        {
+            Key key;
+            uint32_t size;
+            // Offset in the staging buffer to write to, only valid when staged
+            uint32_t stagingOffset;
+            // Uploads larger than a whole frame's budget can't be staged and are written directly
+            bool staged;
+        };
+
+        ChunkUploadQueue(uint32_t frameBudget, int regionCount = 2);
+
+        // Queue an upload of size bytes for the key, or update the size of a queued one
+        void Enqueue(Key key, uint32_t size);
+        void Cancel(Key key);
+        bool IsQueued(Key key) const { return m_queued.contains(key); }
+
+        // Start a frame on the next staging region. fenceSignalled is asked about the fence the
+        // region was last closed with; once it returns true the queue forgets that fence.
+        // Returns false if the GPU is still using the region, nothing is uploaded that frame.
+        bool BeginFrame(const std::function<bool(uint64_t fence)>& fenceSignalled);
+        // Take the next upload if it fits in what is left of this frame's budget
+        bool Next(Upload& outUpload);
+        // Close the frame. createFence is only called if the frame staged anything.
+        void EndFrame(const std::function<uint64_t()>& createFence);
+        // Hand every fence still held to release and treat all regions as free, used on shutdown
+        void ReleaseFences(const std::function<void(uint64_t fence)>& release);
+
+        uint32_t GetFrameBudget() const { return m_frameBudget; }
+        uint32_t GetStagingSize() const { return m_frameBudget * (uint32_t)m_regions.size(); }
+        // Bytes uploaded in the current frame
+        uint32_t GetFrameBytes() const { return m_frameBytes; }
+        size_t GetQueuedCount() const { return m_queued.size(); }
+        uint64_t GetQueuedBytes() const { return m_queuedBytes; }
+
+    private:
+        struct Region
+        {
+            bool busy = false;
+            uint64_t fence = 0;
+        };
+
+        uint32_t m_frameBudget;
+        std::vector<Region> m_regions;
+        int m_currentRegion = -1;
+        bool m_frameOpen = false;
+        uint32_t m_frameBytes = 0;
+        bool m_frameStaged = false;
+
+        // m_queued is authoritative, the order may hold stale keys that were cancelled
+        std::deque<Key> m_order;
+        std::unordered_map<Key, uint32_t> m_queued;
+        uint64_t m_queuedBytes = 0;
+    };
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <wv/wvpch.h>
+
+namespace WillowVox
+{
+    // View frustum as six planes, used to cull chunks on the CPU before they are drawn
+    class Frustum
+    {
+    public:
+        // Extract the planes from a combined projection * view matrix (OpenGL clip space)
+        static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+        // Returns false only if the box is completely outside one of the planes
+        bool IntersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+
+    private:
+        // Plane normals point into the frustum: dot(normal, p) + w >= 0 inside
+        glm::vec4 m_planes[6];
+    };
+}
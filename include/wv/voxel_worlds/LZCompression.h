@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace WillowVox
+{
+    // Byte compressor in the style of the LZ4 block format
+    // The input is a list of sequences, each a run of literal bytes followed by a copy of at least
+    // MIN_MATCH bytes from up to 64 KiB back. A token byte holds both lengths in its two nibbles,
+    // and longer lengths continue in extra bytes of 255. Matches are found through a single hash
+    // table of 4-byte prefixes, which trades some ratio for speed in both directions.
+    namespace LZCompression
+    {
+        constexpr int MIN_MATCH = 4;
+
+        // Append the compressed input to out
+        void Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+        // Decompress into exactly outSize bytes
+        // Returns false if the input is malformed or doesn't decompress to exactly outSize bytes
+        bool Decompress(const uint8_t* data, size_t size, uint8_t* out, size_t outSize);
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <wv/voxel_worlds/ChunkDefines.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace WillowVox
+{
+    // Block light and sky light for a single chunk, packed into one byte per voxel
+    // The low nibble holds the block light level and the high nibble the sky light level.
+    // Both channels can be written from different lighting jobs at the same time, so each
+    // byte is updated with a compare-exchange rather than a plain read-modify-write.
+    //
+    // Chunks that are fully lit or fully dark are represented by a single uniform value; the
+    // per-voxel array is only allocated on the first write that breaks the uniformity. Once
+    // allocated the array is kept for the lifetime of the storage so concurrent readers never
+    // see it freed.
+    class PackedLightStorage
+    {
+    public:
+        static constexpr uint8_t BLOCK_LIGHT_MASK = 0x0F;
+        static constexpr uint8_t SKY_LIGHT_MASK = 0xF0;
+        static constexpr int SKY_LIGHT_SHIFT = 4;
+
+        static constexpr uint8_t Pack(int lightLevel, int skyLightLevel) noexcept
+        {
+            return (uint8_t)((skyLightLevel << SKY_LIGHT_SHIFT) | lightLevel);
+        }
+
+        inline uint8_t GetPacked(int index) const noexcept
+        {
+            const std::atomic<uint8_t>* levels = m_levels.load(std::memory_order_acquire);
+            if (!levels)
+                return m_uniform.load(std::memory_order_relaxed);
+            return levels[index].load(std::memory_order_relaxed);
+        }
+
+        inline int GetLightLevel(int index) const noexcept
+        {
+            return GetPacked(index) & BLOCK_LIGHT_MASK;
+        }
+
+        inline int GetSkyLightLevel(int index) const noexcept
+        {
+            return GetPacked(index) >> SKY_LIGHT_SHIFT;
+        }
+
+        inline void SetLightLevel(int index, int value)
+        {
+            Update(index, BLOCK_LIGHT_MASK, (uint8_t)std::clamp(value, 0, MAX_LIGHT_LEVEL));
+        }
+
+        inline void SetSkyLightLevel(int index, int value)
+        {
+            Update(index, SKY_LIGHT_MASK, (uint8_t)(std::clamp(value, 0, MAX_LIGHT_LEVEL) << SKY_LIGHT_SHIFT));
+        }
+
+        // Set every voxel to the given packed value and return to the uniform representation
+        // Readers are safe, but not writers: an Update racing the Fill can land in the detached
+        // array and be lost. Lighting fills while holding the region lock for both channels.
+        inline void Fill(uint8_t packed)
+        {
+            std::lock_guard<std::mutex> lock(m_allocationMutex);
+            m_uniform.store(packed, std::memory_order_relaxed);
+            m_levels.store(nullptr, std::memory_order_release);
+        }
+
+        // Copy CHUNK_VOLUME packed values, staying uniform if they are all the same
+        // Not safe to call while other threads are reading
+        inline void Load(const uint8_t* packed)
+        {
+            if (std::all_of(packed, packed + CHUNK_VOLUME, [&](uint8_t value) { return value == packed[0]; }))
+            {
+                Fill(packed[0]);
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_allocationMutex);
+            if (!m_array)
+                m_array = std::make_unique<std::atomic<uint8_t>[]>(CHUNK_VOLUME);
+            for (int i = 0; i < CHUNK_VOLUME; ++i)
+                m_array[i].store(packed[i], std::memory_order_relaxed);
+
+            m_levels.store(m_array.get(), std::memory_order_release);
+        }
+
+        bool IsUniform() const noexcept { return m_levels.load(std::memory_order_acquire) == nullptr; }
+
+    private:
+        inline void Update(int index, uint8_t mask, uint8_t bits)
+        {
+            std::atomic<uint8_t>* levels = m_levels.load(std::memory_order_acquire);
+            if (!levels)
+            {
+                // Writes that keep the chunk uniform don't need an array
+                if ((m_uniform.load(std::memory_order_relaxed) & mask) == bits)
+                    return;
+                levels = Allocate();
+            }
+
+            auto& level = levels[index];
+            uint8_t current = level.load(std::memory_order_relaxed);
+            while (!level.compare_exchange_weak(current, (uint8_t)((current & ~mask) | bits), std::memory_order_relaxed))
+            {
+            }
+        }
+
+        inline std::atomic<uint8_t>* Allocate()
+        {
+            std::lock_guard<std::mutex> lock(m_allocationMutex);
+            if (auto* levels = m_levels.load(std::memory_order_acquire))
+                return levels; // Another writer got here first
+
+            if (!m_array)
+                m_array = std::make_unique<std::atomic<uint8_t>[]>(CHUNK_VOLUME);
+
+            uint8_t uniform = m_uniform.load(std::memory_order_relaxed);
+            for (int i = 0; i < CHUNK_VOLUME; ++i)
+                m_array[i].store(uniform, std::memory_order_relaxed);
+
+            m_levels.store(m_array.get(), std::memory_order_release);
+            return m_array.get();
+        }
+
+        std::atomic<uint8_t> m_uniform = 0;
+        std::atomic<std::atomic<uint8_t>*> m_levels = nullptr;
+        std::unique_ptr<std::atomic<uint8_t>[]> m_array;
+        std::mutex m_allocationMutex;
+    };
+}
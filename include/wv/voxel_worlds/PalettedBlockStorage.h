@@ -0,0 +1,95 @@
+#pragma once
+
+#include <wv/voxel_worlds/ChunkDefines.h>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace WillowVox
+{
+    // Palette-compressed block storage for a single chunk
+    // Every voxel stores an index into a per-chunk palette of block ids. The indices are bit-packed
+    // into 64-bit words and widen on demand (0, 1, 2, 4 or 8 bits per voxel), so a chunk with
+    // a handful of block types only costs a few KiB instead of a full BlockId array.
+    // Past 256 block types a palette costs more than it saves, so the voxels store raw block ids.
+    //
+    // Set() must only be called from one thread at a time, but Get() may run concurrently with it.
+    // Layouts replaced while growing are kept alive until the storage is refilled or compacted, so
+    // readers never see freed memory. Each widening retires one layout, so at most five are kept.
+    class PalettedBlockStorage
+    {
+    public:
+        PalettedBlockStorage(BlockId fillValue = 0);
+
+        PalettedBlockStorage(const PalettedBlockStorage&) = delete;
+        PalettedBlockStorage& operator=(const PalettedBlockStorage&) = delete;
+
+        inline BlockId Get(int index) const noexcept
+        {
+            const Layout* layout = m_layout.load(std::memory_order_acquire);
+            if (layout->bitsPerIndex == 0)
+                return layout->palette[0];
+
+            // Index widths are powers of two, so an index never straddles two words
+            int bit = index * layout->bitsPerIndex;
+            uint64_t word = layout->words[bit >> 6].load(std::memory_order_acquire);
+            uint64_t packed = (word >> (bit & 63)) & layout->indexMask;
+            return layout->raw ? (BlockId)packed : layout->palette[packed];
+        }
+
+        void Set(int index, BlockId value);
+        // Set count consecutive voxels starting at index, writing whole words where possible
+        void SetRange(int index, int count, BlockId value);
+
+        // Widen the indices up front so the palette can hold paletteSize entries without growing
+        void Reserve(size_t paletteSize);
+
+        // Reset every voxel to the given value and release the packed indices
+        // Not safe to call while other threads are reading
+        void Fill(BlockId value);
+
+        // Drop unused palette entries and shrink the index width as far as possible
+        // A storage holding a single block type returns to the uniform representation.
+        // Not safe to call while other threads are reading
+        void Compact();
+
+        bool IsUniform() const noexcept { return m_layout.load(std::memory_order_acquire)->bitsPerIndex == 0; }
+        bool IsRaw() const noexcept { return m_layout.load(std::memory_order_acquire)->raw; }
+        int GetBitsPerIndex() const noexcept { return m_layout.load(std::memory_order_acquire)->bitsPerIndex; }
+        // 0 while storing raw block ids
+        size_t GetPaletteSize() const noexcept { return m_paletteSize; }
+
+    private:
+        struct Layout
+        {
+            Layout(int bitsPerIndex);
+
+            int bitsPerIndex;
+            uint64_t indexMask;
+            bool raw; // The packed values are block ids rather than palette indices
+            std::unique_ptr<BlockId[]> palette; // Capacity of 1 << bitsPerIndex entries, none when raw
+            std::unique_ptr<std::atomic<uint64_t>[]> words;
+        };
+
+        static int GetBitsForPaletteSize(size_t paletteSize);
+        // The block id itself in the raw layout
+        static uint64_t GetPaletteIndex(const Layout& layout, int index);
+
+        int FindPaletteIndex(BlockId value) const;
+        // Find the value in the palette or add it, growing the layout if the palette is full
+        // Returns the value to pack, which is the block id itself in the raw layout
+        uint64_t GetOrAddPaletteIndex(BlockId value);
+        void Grow();
+        // Repack into a layout with the given index width and return the replaced layout
+        std::unique_ptr<Layout> Rebuild(int newBits, bool dropUnused);
+
+        std::atomic<Layout*> m_layout;
+        std::unique_ptr<Layout> m_currentLayout;
+        std::vector<std::unique_ptr<Layout>> m_retiredLayouts;
+
+        size_t m_paletteSize = 0;
+        // Only populated once the palette is too large for a linear scan
+        std::unordered_map<BlockId, uint16_t> m_paletteLookup;
+    };
+}
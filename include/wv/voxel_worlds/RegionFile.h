@@ -0,0 +1,72 @@
+#pragma once
+
+#include <wv/wvpch.h>
+#include <wv/voxel_worlds/MappedFile.h>
+#include <filesystem>
+#include <fstream>
+
+namespace WillowVox
+{
+    // One file holding the saved chunks of a REGION_SIZE^3 block of chunks
+    // The file starts with a header and a table of (offset, size) for every chunk of the region,
+    // followed by the chunk payloads. A rewritten chunk that still fits replaces its old payload in
+    // place, otherwise it is appended and the old payload becomes garbage. Once there is more
+    // garbage than live data the file is compacted into a new file that replaces it.
+    //
+    // Reads go through a memory mapping of the file, so payloads are handed out in place without
+    // being copied. The mapping is dropped by writes and mapped again by the next read.
+    //
+    // All numbers are stored little endian. Not thread safe.
+    class RegionFile
+    {
+    public:
+        static constexpr int REGION_BITS = 3;
+        static constexpr int REGION_SIZE = 1 << REGION_BITS;
+        static constexpr int CHUNKS_PER_REGION = REGION_SIZE * REGION_SIZE * REGION_SIZE;
+
+        static constexpr uint32_t MAGIC = 0x47525657; // "WVRG"
+        // Version 2 payloads are ChunkSerializer output with its own header
+        static constexpr uint32_t VERSION = 2;
+        static constexpr uint32_t HEADER_SIZE = 8 + CHUNKS_PER_REGION * 8;
+
+        static glm::ivec3 GetRegionId(const glm::ivec3& chunkId) { return { chunkId.x >> REGION_BITS, chunkId.y >> REGION_BITS, chunkId.z >> REGION_BITS }; }
+        // Slot of a chunk in its region's table
+        static int GetChunkIndex(const glm::ivec3& chunkId)
+        {
+            glm::ivec3 local = { chunkId.x & (REGION_SIZE - 1), chunkId.y & (REGION_SIZE - 1), chunkId.z & (REGION_SIZE - 1) };
+            return local.y + REGION_SIZE * (local.x + REGION_SIZE * local.z);
+        }
+
+        // Reads the table if the file exists. A missing file is only created on the first write.
+        explicit RegionFile(std::filesystem::path path);
+
+        bool Contains(int chunkIndex) const { return m_entries[chunkIndex].size > 0; }
+
+        // Point outData at a chunk's payload inside the mapped file, valid until the next write
+        // Returns false if the chunk isn't saved or the file can't be mapped
+        bool Read(int chunkIndex, const uint8_t*& outData, uint32_t& outSize);
+        bool Write(int chunkIndex, const uint8_t* data, uint32_t size);
+
+        uint64_t GetFileSize() const { return m_fileSize; }
+        uint64_t GetLiveBytes() const { return m_liveBytes; }
+
+    private:
+        struct Entry
+        {
+            uint32_t offset = 0;
+            uint32_t size = 0;
+        };
+
+        bool Create();
+        bool WriteEntry(int chunkIndex);
+        bool Compact();
+
+        std::filesystem::path m_path;
+        // Only opened for writing
+        std::fstream m_file;
+        MappedFile m_mapping;
+        Entry m_entries[CHUNKS_PER_REGION];
+        uint64_t m_fileSize = 0;
+        uint64_t m_liveBytes = 0;
+    };
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <wv/voxel_worlds/ChunkData.h>
+#include <wv/voxel_worlds/RegionFile.h>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace WillowVox
+{
+    // Saved chunks of a world, stored as region files in one directory
+    // Regions are opened on first use and the least recently used ones are closed once more than
+    // MAX_OPEN_REGIONS are open. Each region has its own lock, so chunks in different regions are
+    // read and written in parallel.
+    class RegionStore
+    {
+    public:
+        static constexpr size_t MAX_OPEN_REGIONS = 32;
+
+        explicit RegionStore(std::filesystem::path directory);
+
+        // Fill the chunk with its saved blocks, returns false if it was never saved
+        bool Load(ChunkData& chunkData);
+        bool Save(const ChunkData& chunkData);
+
+    private:
+        struct Region
+        {
+            explicit Region(std::filesystem::path path) : file(std::move(path)) {}
+
+            std::mutex mutex;
+            RegionFile file;
+            uint64_t lastUse = 0;
+        };
+
+        std::shared_ptr<Region> GetRegion(const glm::ivec3& regionId);
+
+        std::filesystem::path m_directory;
+
+        std::unordered_map<glm::ivec3, std::shared_ptr<Region>> m_regions;
+        uint64_t m_useCounter = 0;
+        std::mutex m_regionsMutex;
+    };
+}
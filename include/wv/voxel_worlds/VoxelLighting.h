@@ -2,6 +2,7 @@
 
 #include <wv/wvpch.h>
 #include <unordered_set>
+#include <vector>
 
 namespace WillowVox
 {
@@ -10,8 +11,18 @@ namespace WillowVox
 
     namespace VoxelLighting
     {
+        // A voxel whose block was changed, see UpdateLighting
+        struct LightChange
+        {
+            ChunkData* chunkData;
+            int x, y, z;
+            // Light emitted by the new block, 0 if it doesn't emit light
+            int lightLevel;
+        };
+
         // Calculate full lighting for the given chunk
         // Only do this during initial generation as it is expensive
+        // It refills the chunk's light, so hold a RegionLock for the chunk and AllLight around it
         // Returns a set of chunk ids that need to be remeshed
         std::unordered_set<glm::ivec3> CalculateFullLighting(ChunkManager* chunkManager, ChunkData* chunkData);
 
@@ -39,7 +50,45 @@ namespace WillowVox
         // Returns a set of chunk ids that need to be remeshed
         std::unordered_set<glm::ivec3> RemoveLightBlocker(ChunkManager* chunkManager, ChunkData* chunkData, int x, int y, int z);
 
-        extern std::mutex lightingMutex;
-        extern std::mutex skyLightingMutex;
+        // Update block and sky light around many changed voxels at once
+        // The new blocks must already be written. Light is removed from every change in one pass and
+        // then spread again in one pass, so overlapping changes don't repeat the same work.
+        // Returns a set of chunk ids that need to be remeshed
+        std::unordered_set<glm::ivec3> UpdateLighting(ChunkManager* chunkManager, const std::vector<LightChange>& changes);
+
+        enum LightChannels : uint8_t
+        {
+            BlockLight = 1 << 0,
+            SkyLight = 1 << 1,
+            AllLight = BlockLight | SkyLight
+        };
+
+        // Locks the chunk columns a lighting update can reach, instead of the whole world
+        // Light loses a level per block sideways and MAX_LIGHT_LEVEL < CHUNK_SIZE, so an update
+        // starting in a chunk stays within the neighboring columns. Sky light can fall any distance,
+        // but only straight down.
+        // Each channel has 64 mutexes, one per column position modulo 8 on x and z, always locked in
+        // the same order. Updates whose columns are 3 to 5 apart along x or z run at the same time,
+        // as do any more than two but less than six columns apart. Updates further apart can still
+        // wait on each other when their distance on both axes is close to a multiple of 8.
+        class RegionLock
+        {
+        public:
+            // Lock the columns around every given chunk
+            RegionLock(const std::vector<glm::ivec3>& chunkIds, LightChannels channels);
+            RegionLock(const glm::ivec3& chunkId, LightChannels channels);
+            // Lock every column, waiting for all running updates of the channels to finish
+            explicit RegionLock(LightChannels channels);
+            ~RegionLock();
+
+            RegionLock(const RegionLock&) = delete;
+            RegionLock& operator=(const RegionLock&) = delete;
+
+        private:
+            void Lock(uint64_t stripes, LightChannels channels);
+
+            uint64_t m_stripes = 0;
+            LightChannels m_channels;
+        };
     }
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#version 330 core
+
+// Reference vertex shader for batched chunk rendering, load it as the "chunk_batch_shader" asset
+// Decodes the same packed vertex as chunk_shader.vert
+// data0: x (6 bits) | y (6) | z (6) | face (3) | corner (2) | light level (4) | sky light level (4)
+// data1: atlas tile (16 bits) | log2 atlas width in tiles (4) | log2 atlas height in tiles (4)
+layout(location = 0) in ivec2 aData;
+
+// Chunk position in blocks, a per-instance attribute (divisor 1). Each draw command's
+// baseInstance selects its chunk's entry, so there is no model uniform.
+layout(location = 1) in vec3 aChunkOffset;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 Normal;
+out vec2 TexCoord;
+flat out vec2 TileOrigin;
+flat out vec2 AtlasSize;
+flat out float LightLevel;
+flat out float SkyLightLevel;
+
+// Vertex face order: south, north, east, west, up, down
+const vec3 FACE_NORMALS[6] = vec3[6](
+    vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, -1.0),
+    vec3(1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0),
+    vec3(0.0, 1.0, 0.0), vec3(0.0, -1.0, 0.0)
+);
+
+// Texture axes of each face, in blocks, oriented like the old per-vertex coordinates
+vec2 FaceTexCoord(int face, vec3 pos)
+{
+    if (face == 0) return vec2(pos.x, pos.y);
+    if (face == 1) return vec2(-pos.x, pos.y);
+    if (face == 2) return vec2(-pos.z, pos.y);
+    if (face == 3) return vec2(pos.z, pos.y);
+    if (face == 4) return vec2(pos.x, -pos.z);
+    return vec2(-pos.x, -pos.z);
+}
+
+void main()
+{
+    uint data0 = uint(aData.x);
+    uint data1 = uint(aData.y);
+
+    vec3 pos = vec3(uvec3(data0, data0 >> 6u, data0 >> 12u) & 0x3Fu);
+    int face = int(data0 >> 18u & 0x7u);
+    LightLevel = float(data0 >> 23u & 0xFu);
+    SkyLightLevel = float(data0 >> 27u & 0xFu);
+
+    uint tile = data1 & 0xFFFFu;
+    uint atlasWidthBits = data1 >> 16u & 0xFu;
+    AtlasSize = vec2(1u << atlasWidthBits, 1u << (data1 >> 20u & 0xFu));
+    TileOrigin = vec2(tile & ((1u << atlasWidthBits) - 1u), tile >> atlasWidthBits);
+
+    Normal = FACE_NORMALS[face];
+    TexCoord = FaceTexCoord(face, pos);
+    gl_Position = projection * view * vec4(aChunkOffset + pos, 1.0);
+}
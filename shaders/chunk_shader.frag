@@ -0,0 +1,26 @@
+#version 330 core
+
+// Reference fragment shader for both chunk_shader.vert and chunk_batch_shader.vert
+// The chunk texture atlas is bound to texture unit 0
+
+in vec3 Normal;
+in vec2 TexCoord;
+flat in vec2 TileOrigin;
+flat in vec2 AtlasSize;
+flat in float LightLevel;
+flat in float SkyLightLevel;
+
+uniform sampler2D tex;
+
+out vec4 FragColor;
+
+void main()
+{
+    // Greedy quads span several blocks, so the tile repeats once per block
+    // Gradients come from the unwrapped coordinates so mip selection doesn't jump at block edges
+    vec2 uv = (TileOrigin + fract(TexCoord)) / AtlasSize;
+    vec4 color = textureGrad(tex, uv, dFdx(TexCoord) / AtlasSize, dFdy(TexCoord) / AtlasSize);
+
+    float light = max(max(LightLevel, SkyLightLevel) / 15.0, 0.05);
+    FragColor = vec4(color.rgb * light, color.a);
+}
@@ -84,6 +84,8 @@ namespace WillowVox
             else
                 atlasHeight *= 2;
         }
+        m_atlasWidth = atlasWidth;
+        m_atlasHeight = atlasHeight;
 
         // Get size of textures
         int texWidth, texHeight;
@@ -154,6 +156,9 @@ namespace WillowVox
                 sidePos.x, sidePos.z, sidePos.y, sidePos.w,
                 tex.lightEmitter, tex.lightLevel
             );
+            block.topTexIndex = tex.top;
+            block.bottomTexIndex = tex.bottom;
+            block.sideTexIndex = tex.side;
             m_blocks[tex.id] = block;
             m_strIdToNumId[strId] = tex.id;
         }
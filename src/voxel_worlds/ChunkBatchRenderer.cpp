@@ -0,0 +1,270 @@
+#include <wv/voxel_worlds/ChunkBatchRenderer.h>
+#include <algorithm>
+#include <cstring>
+
+#if __has_include(<glad/glad.h>)
+#include <glad/glad.h>
+#define WV_CHUNK_BATCHING
+#elif __has_include(<glad/gl.h>)
+#include <glad/gl.h>
+#define WV_CHUNK_BATCHING
+#endif
+
+namespace WillowVox
+{
+    // 8 MB of vertices to start with, doubled whenever it runs out
+    static constexpr uint32_t INITIAL_ARENA_VERTICES = 1 << 20;
+    // Ranges are rounded up so a chunk that grows a little after an edit keeps its range
+    static constexpr uint32_t ALLOCATION_GRANULARITY = 256;
+    // Staging regions, so the CPU fills one while the GPU copies from the other
+    static constexpr int STAGING_REGION_COUNT = 2;
+
+    // Set when the staging buffer couldn't be mapped, the context is treated as unsupported from then on
+    static bool s_stagingMapFailed = false;
+
+    bool ChunkBatchRenderer::IsSupported()
+    {
+#ifdef WV_CHUNK_BATCHING
+        if (s_stagingMapFailed)
+            return false;
+
+        return glMultiDrawElementsIndirect != nullptr && glCopyBufferSubData != nullptr && glVertexAttribDivisor != nullptr &&
+            glBufferStorage != nullptr && glFenceSync != nullptr;
+#else
+        return false;
+#endif
+    }
+
+    ChunkBatchRenderer::ChunkBatchRenderer(uint32_t uploadBudget)
+        : m_uploadQueue(uploadBudget, STAGING_REGION_COUNT)
+    {
+    }
+
+    ChunkBatchRenderer::~ChunkBatchRenderer()
+    {
+#ifdef WV_CHUNK_BATCHING
+        m_uploadQueue.ReleaseFences([](uint64_t fence) { glDeleteSync((GLsync)fence); });
+#endif
+        ReleaseBuffers();
+    }
+
+    void ChunkBatchRenderer::ReleaseBuffers()
+    {
+#ifdef WV_CHUNK_BATCHING
+        if (!m_vao)
+            return;
+
+        if (m_stagingData)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, m_stagingBuffer);
+            glUnmapBuffer(GL_COPY_READ_BUFFER);
+            m_stagingData = nullptr;
+        }
+
+        // Deleting buffer 0 is ignored, so buffers that were never created are fine
+        GLuint buffers[] = { m_vertexBuffer, m_stagingBuffer, m_chunkOffsetBuffer, m_commandBuffer };
+        glDeleteBuffers(4, buffers);
+        glDeleteVertexArrays(1, &m_vao);
+        m_vao = m_vertexBuffer = m_stagingBuffer = m_chunkOffsetBuffer = m_commandBuffer = 0;
+#endif
+    }
+
+    void ChunkBatchRenderer::BeginFrame()
+    {
+        m_frameChunks.clear();
+    }
+
+    void ChunkBatchRenderer::AddChunk(ChunkRenderer& chunk)
+    {
+        auto& allocation = m_allocations[&chunk];
+        allocation.chunkId = chunk.m_chunkId;
+
+        // Only the latest mesh of a chunk is kept, an older one still in the queue is replaced
+        if (chunk.CopyMeshIfDirty(allocation.pendingVertices))
+            m_uploadQueue.Enqueue(&chunk, (uint32_t)(allocation.pendingVertices.size() * sizeof(ChunkRenderer::ChunkVertex)));
+
+        m_frameChunks.push_back(&allocation);
+    }
+
+    void ChunkBatchRenderer::RemoveChunk(const ChunkRenderer* chunk)
+    {
+        auto it = m_allocations.find(chunk);
+        if (it == m_allocations.end())
+            return;
+
+        m_uploadQueue.Cancel(chunk);
+        if (it->second.capacity > 0)
+            m_arena.Free(it->second.offset, it->second.capacity);
+        m_allocations.erase(it);
+    }
+
+    void ChunkBatchRenderer::Draw()
+    {
+#ifdef WV_CHUNK_BATCHING
+        if (!m_vao && !CreateBuffers())
+            return;
+
+        UploadPendingMeshes();
+
+        m_commands.Clear();
+        for (auto* allocation : m_frameChunks)
+            m_commands.AddChunk(allocation->chunkId, allocation->offset, allocation->quadCount);
+
+        if (m_commands.Empty())
+            return;
+
+        // Every draw uses the same quad index pattern, offset by its base vertex
+        GLuint indexBuffer = ChunkRenderer::GetQuadIndexBuffer(m_commands.GetMaxQuadCount());
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+        auto& chunkOffsets = m_commands.GetChunkOffsets();
+        glBindBuffer(GL_ARRAY_BUFFER, m_chunkOffsetBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(chunkOffsets.size() * sizeof(glm::vec3)), chunkOffsets.data(), GL_STREAM_DRAW);
+
+        auto& commands = m_commands.GetCommands();
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)(commands.size() * sizeof(ChunkDrawCommandBuilder::DrawCommand)), commands.data(), GL_STREAM_DRAW);
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)commands.size(), 0);
+
+        glBindVertexArray(0);
+#endif
+    }
+
+    void ChunkBatchRenderer::UploadPendingMeshes()
+    {
+#ifdef WV_CHUNK_BATCHING
+        // Skip uploading this frame if the GPU hasn't finished copying out of the staging region yet
+        bool regionFree = m_uploadQueue.BeginFrame([](uint64_t fence) {
+            GLenum result = glClientWaitSync((GLsync)fence, 0, 0);
+            if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+                return false;
+
+            glDeleteSync((GLsync)fence);
+            return true;
+        });
+        if (!regionFree)
+            return;
+
+        ChunkUploadQueue::Upload upload;
+        while (m_uploadQueue.Next(upload))
+        {
+            auto it = m_allocations.find((const ChunkRenderer*)upload.key);
+            if (it != m_allocations.end())
+                UploadMesh(it->second, upload);
+        }
+
+        // The fence covers the copies out of this frame's staging region
+        m_uploadQueue.EndFrame([] { return (uint64_t)glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0); });
+#endif
+    }
+
+    void ChunkBatchRenderer::UploadMesh(ChunkAllocation& allocation, const ChunkUploadQueue::Upload& upload)
+    {
+#ifdef WV_CHUNK_BATCHING
+        auto& vertices = allocation.pendingVertices;
+        uint32_t vertexCount = (uint32_t)vertices.size();
+
+        // Empty meshes give their range back, larger meshes move to a new one. Draws already
+        // submitted from the old range are ordered before any later copy into it by the driver.
+        if (allocation.capacity > 0 && (vertexCount == 0 || vertexCount > allocation.capacity))
+        {
+            m_arena.Free(allocation.offset, allocation.capacity);
+            allocation.capacity = 0;
+        }
+        if (vertexCount > 0 && allocation.capacity == 0)
+        {
+            uint32_t capacity = (vertexCount + ALLOCATION_GRANULARITY - 1) / ALLOCATION_GRANULARITY * ALLOCATION_GRANULARITY;
+            while (!m_arena.Allocate(capacity, allocation.offset))
+                GrowVertexBuffer(std::max(m_arena.GetCapacity() * 2, m_arena.GetCapacity() + capacity));
+            allocation.capacity = capacity;
+        }
+
+        if (vertexCount > 0)
+        {
+            // Bound per mesh since growing the arena rebinds the copy targets
+            glBindBuffer(GL_COPY_READ_BUFFER, m_stagingBuffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_vertexBuffer);
+
+            GLintptr offset = (GLintptr)allocation.offset * sizeof(ChunkRenderer::ChunkVertex);
+            if (upload.staged)
+            {
+                std::memcpy(m_stagingData + upload.stagingOffset, vertices.data(), upload.size);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, upload.stagingOffset, offset, upload.size);
+            }
+            else
+            {
+                glBufferSubData(GL_COPY_WRITE_BUFFER, offset, upload.size, vertices.data());
+            }
+        }
+
+        allocation.quadCount = vertexCount / 4;
+        vertices.clear();
+#endif
+    }
+
+    bool ChunkBatchRenderer::CreateBuffers()
+    {
+#ifdef WV_CHUNK_BATCHING
+        glGenVertexArrays(1, &m_vao);
+        glGenBuffers(1, &m_chunkOffsetBuffer);
+        glGenBuffers(1, &m_commandBuffer);
+
+        glBindVertexArray(m_vao);
+
+        // Chunk position per draw, selected by the command's base instance
+        glBindBuffer(GL_ARRAY_BUFFER, m_chunkOffsetBuffer);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), nullptr);
+        glVertexAttribDivisor(1, 1);
+        glBindVertexArray(0);
+
+        // Mapped once for the renderer's lifetime, coherent so written data needs no flush
+        glGenBuffers(1, &m_stagingBuffer);
+        glBindBuffer(GL_COPY_READ_BUFFER, m_stagingBuffer);
+        GLbitfield stagingFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_READ_BUFFER, m_uploadQueue.GetStagingSize(), nullptr, stagingFlags);
+        m_stagingData = (uint8_t*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, m_uploadQueue.GetStagingSize(), stagingFlags);
+        if (!m_stagingData)
+        {
+            Logger::Error("Failed to map the chunk staging buffer (GL error %u), batched chunk rendering is unavailable", (unsigned)glGetError());
+            ReleaseBuffers();
+            s_stagingMapFailed = true;
+            return false;
+        }
+
+        GrowVertexBuffer(INITIAL_ARENA_VERTICES);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void ChunkBatchRenderer::GrowVertexBuffer(uint32_t capacity)
+    {
+#ifdef WV_CHUNK_BATCHING
+        GLuint buffer;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity * sizeof(ChunkRenderer::ChunkVertex), nullptr, GL_DYNAMIC_DRAW);
+
+        // Existing meshes keep their offsets in the larger buffer
+        if (m_vertexBuffer)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, m_vertexBuffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                (GLsizeiptr)m_arena.GetCapacity() * sizeof(ChunkRenderer::ChunkVertex));
+            glDeleteBuffers(1, &m_vertexBuffer);
+        }
+        m_vertexBuffer = buffer;
+        m_arena.Grow(capacity);
+
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+        glEnableVertexAttribArray(0);
+        glVertexAttribIPointer(0, 2, GL_INT, sizeof(ChunkRenderer::ChunkVertex), (const void*)offsetof(ChunkRenderer::ChunkVertex, data0));
+        glBindVertexArray(0);
+#endif
+    }
+}
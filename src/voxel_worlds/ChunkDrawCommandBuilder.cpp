@@ -0,0 +1,22 @@
+#include <wv/voxel_worlds/ChunkDrawCommandBuilder.h>
+#include <algorithm>
+
+namespace WillowVox
+{
+    void ChunkDrawCommandBuilder::Clear()
+    {
+        m_commands.clear();
+        m_chunkOffsets.clear();
+        m_maxQuadCount = 0;
+    }
+
+    void ChunkDrawCommandBuilder::AddChunk(const glm::ivec3& chunkId, uint32_t vertexOffset, uint32_t quadCount)
+    {
+        if (quadCount == 0)
+            return;
+
+        m_commands.push_back({ quadCount * 6, 1, 0, (int32_t)vertexOffset, (uint32_t)m_chunkOffsets.size() });
+        m_chunkOffsets.push_back(glm::vec3(chunkId * CHUNK_SIZE));
+        m_maxQuadCount = std::max(m_maxQuadCount, quadCount);
+    }
+}
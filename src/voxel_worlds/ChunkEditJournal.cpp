@@ -0,0 +1,46 @@
+#include <wv/voxel_worlds/ChunkEditJournal.h>
+
+namespace WillowVox
+{
+    void ChunkEditJournal::Record(int index, BlockId oldId, BlockId newId, uint64_t tick)
+    {
+        if (oldId == newId)
+            return;
+
+        auto [it, inserted] = m_voxelEdits.try_emplace((uint16_t)index, (uint32_t)m_edits.size());
+        if (inserted)
+        {
+            m_edits.push_back({ (uint16_t)index, oldId, newId, tick });
+            return;
+        }
+
+        BlockEdit& edit = m_edits[it->second];
+        edit.newId = newId;
+        edit.tick = tick;
+        if (edit.newId == edit.oldId)
+            m_voxelEdits.erase(it);
+    }
+
+    void ChunkEditJournal::Drain(std::vector<BlockEdit>& out)
+    {
+        for (auto& edit : m_edits)
+        {
+            if (edit.oldId != edit.newId)
+                out.push_back(edit);
+        }
+
+        m_edits.clear();
+        m_voxelEdits.clear();
+    }
+
+    void ChunkEditJournal::Apply(ChunkData& chunkData, const std::vector<BlockEdit>& edits)
+    {
+        for (auto& edit : edits)
+        {
+            int y = edit.index % CHUNK_SIZE;
+            int x = edit.index / CHUNK_SIZE % CHUNK_SIZE;
+            int z = edit.index / (CHUNK_SIZE * CHUNK_SIZE);
+            chunkData.Set(x, y, z, edit.newId);
+        }
+    }
+}
@@ -0,0 +1,132 @@
+#include <wv/voxel_worlds/ChunkLoadScheduler.h>
+#include <algorithm>
+
+namespace WillowVox
+{
+    // The queue is keyed again once the center is more than this many chunks away from the one
+    // it was keyed against, a chunk's priority is off by at most a few chunks of distance until then
+    static constexpr int REKEY_DISTANCE = 2;
+    // How much further away a chunk directly behind the camera counts compared to one in front
+    static constexpr float BEHIND_CAMERA_WEIGHT = 2.0f;
+
+    void ChunkLoadScheduler::SetCenter(const glm::ivec3& center, int renderDistance, int renderHeight)
+    {
+        if (m_hasCenter && center == m_center && renderDistance == m_renderDistance && renderHeight == m_renderHeight)
+            return;
+
+        bool hadCenter = m_hasCenter;
+        glm::ivec3 oldCenter = m_center;
+        int oldDistance = m_renderDistance;
+        int oldHeight = m_renderHeight;
+
+        m_hasCenter = true;
+        m_center = center;
+        m_renderDistance = renderDistance;
+        m_renderHeight = renderHeight;
+
+        glm::ivec3 keyOffset = glm::abs(center - m_keyCenter);
+        bool rekey = !hadCenter || std::max({ keyOffset.x, keyOffset.y, keyOffset.z }) > REKEY_DISTANCE;
+        if (rekey)
+            m_keyCenter = center;
+
+        // Queue chunks that entered the range, skipping the part of each column that was already in it
+        for (int x = -renderDistance + 1; x < renderDistance; x++)
+        {
+            for (int z = -renderDistance + 1; z < renderDistance; z++)
+            {
+                glm::ivec3 column = center + glm::ivec3(x, 0, z);
+                bool columnInOldRange = hadCenter && std::abs(column.x - oldCenter.x) < oldDistance && std::abs(column.z - oldCenter.z) < oldDistance;
+
+                for (int y = -renderHeight; y <= renderHeight; y++)
+                {
+                    glm::ivec3 id = column + glm::ivec3(0, y, 0);
+                    if (columnInOldRange && std::abs(id.y - oldCenter.y) <= oldHeight)
+                    {
+                        y = oldCenter.y + oldHeight - center.y;
+                        continue;
+                    }
+
+                    if (m_queued.insert(id).second && !rekey)
+                    {
+                        m_heap.push_back({ GetPriority(id), id });
+                        std::push_heap(m_heap.begin(), m_heap.end());
+                    }
+                }
+            }
+        }
+
+        if (rekey)
+            RebuildHeap();
+    }
+
+    void ChunkLoadScheduler::SetViewDirection(const glm::vec3& direction)
+    {
+        float length = glm::length(direction);
+        glm::vec3 normalized = length > 0.0f ? direction / length : glm::vec3(0.0f);
+        if (glm::dot(normalized, m_viewDirection) >= VIEW_DIRECTION_THRESHOLD)
+            return;
+
+        m_viewDirection = normalized;
+        RebuildHeap();
+    }
+
+    bool ChunkLoadScheduler::Pop(glm::ivec3& outId)
+    {
+        while (!m_heap.empty())
+        {
+            std::pop_heap(m_heap.begin(), m_heap.end());
+            glm::ivec3 id = m_heap.back().id;
+            m_heap.pop_back();
+
+            // Skip stale entries and chunks that left the range
+            if (m_queued.erase(id) && InRange(id))
+            {
+                outId = id;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void ChunkLoadScheduler::Push(const glm::ivec3& id)
+    {
+        if (!InRange(id) || !m_queued.insert(id).second)
+            return;
+
+        m_heap.push_back({ GetPriority(id), id });
+        std::push_heap(m_heap.begin(), m_heap.end());
+    }
+
+    bool ChunkLoadScheduler::InRange(const glm::ivec3& id) const
+    {
+        if (!m_hasCenter)
+            return false;
+
+        glm::ivec3 offset = glm::abs(id - m_center);
+        return offset.x < m_renderDistance && offset.z < m_renderDistance && offset.y <= m_renderHeight;
+    }
+
+    float ChunkLoadScheduler::GetPriority(const glm::ivec3& id) const
+    {
+        glm::vec3 offset = glm::vec3(id - m_keyCenter);
+        float distance = glm::length(offset);
+        if (distance == 0.0f)
+            return 0.0f;
+
+        // Scale the distance from 1x straight ahead up to BEHIND_CAMERA_WEIGHT straight behind
+        float facing = glm::dot(offset / distance, m_viewDirection);
+        return distance * (1.0f + (BEHIND_CAMERA_WEIGHT - 1.0f) * (1.0f - facing) * 0.5f);
+    }
+
+    void ChunkLoadScheduler::RebuildHeap()
+    {
+        std::erase_if(m_queued, [this](const glm::ivec3& id) { return !InRange(id); });
+
+        m_heap.clear();
+        m_heap.reserve(m_queued.size());
+        for (auto& id : m_queued)
+            m_heap.push_back({ GetPriority(id), id });
+        std::make_heap(m_heap.begin(), m_heap.end());
+    }
+}
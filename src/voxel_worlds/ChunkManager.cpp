@@ -6,8 +6,16 @@
 
 namespace WillowVox
 {
-    ChunkManager::ChunkManager(WorldGen* worldGen, int numChunkThreads, int worldSizeX, int worldMinY, int worldMaxY, int worldSizeZ)
-        : m_worldGen(worldGen), m_worldSizeX(worldSizeX), m_worldMinY(worldMinY), m_worldMaxY(worldMaxY), m_worldSizeZ(worldSizeZ)
+    // South, north, east, west, up, down, matching the ChunkRenderer neighbor setters and face order
+    // Opposite faces differ only in the lowest bit
+    static const glm::ivec3 NEIGHBOR_OFFSETS[6] = {
+        { 0, 0, 1 }, { 0, 0, -1 }, { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }
+    };
+
+    ChunkManager::ChunkManager(WorldGen* worldGen, int numChunkThreads, int worldSizeX, int worldMinY, int worldMaxY, int worldSizeZ,
+        ChunkStorageMode storageMode)
+        : m_worldGen(worldGen), m_chunkData(storageMode), m_chunkRenderers(storageMode), m_worldSizeX(worldSizeX), m_worldMinY(worldMinY), m_worldMaxY(worldMaxY), m_worldSizeZ(worldSizeZ),
+        m_maxChunksInFlight(std::max(numChunkThreads, 1) * 2)
     {
         // Load assets
         auto& am = AssetManager::GetInstance();
@@ -23,19 +31,143 @@ namespace WillowVox
 
     ChunkManager::~ChunkManager()
     {
-        m_chunkThreadShouldStop = true;
+        {
+            std::lock_guard<std::mutex> lock(m_chunkThreadMutex);
+            m_chunkThreadShouldStop = true;
+        }
+        m_chunkThreadCondition.notify_one();
         m_chunkThread.join();
+
+        // Loads, lighting and meshing still running can edit and save chunks
+        m_chunkThreadPool.Drain();
+
+        SaveModifiedChunks();
+    }
+
+    void ChunkManager::SetSaveDirectory(const std::filesystem::path& directory)
+    {
+        // Chunk jobs read the region store without a lock once loading has started
+        if (m_camera)
+        {
+            Logger::Warn("The save directory must be set before the camera, ignoring '%s'", directory.string().c_str());
+            return;
+        }
+
+        m_regionStore = std::make_unique<RegionStore>(directory);
+    }
+
+    void ChunkManager::SaveModifiedChunks()
+    {
+        if (!m_regionStore)
+            return;
+
+        std::vector<std::shared_ptr<ChunkData>> modifiedChunks;
+        m_chunkData.ForEach([&](const glm::ivec3& id, const std::shared_ptr<ChunkData>& data) {
+            if (data->IsModified())
+                modifiedChunks.push_back(data);
+        });
+
+        for (auto& data : modifiedChunks)
+            SaveChunkData(*data);
+    }
+
+    void ChunkManager::SaveChunkData(ChunkData& chunkData)
+    {
+        if (!m_regionStore || !chunkData.IsModified())
+            return;
+
+        // Cleared before writing, so an edit made while saving marks the chunk again
+        chunkData.SetModified(false);
+        m_regionStore->Save(chunkData);
+    }
+
+    // Same rounding the chunk thread has always used for the camera chunk
+    static glm::ivec3 GetCameraChunkId(const glm::vec3& position)
+    {
+        int chunkX = position.x < 0 ? (position.x / CHUNK_SIZE) - 1 : position.x / CHUNK_SIZE;
+        int chunkY = position.y < 0 ? (position.y / CHUNK_SIZE) - 1 : position.y / CHUNK_SIZE;
+        int chunkZ = position.z < 0 ? (position.z / CHUNK_SIZE) - 1 : position.z / CHUNK_SIZE;
+
+        return { chunkX, chunkY, chunkZ };
+    }
+
+    void ChunkManager::SetCamera(Camera* camera)
+    {
+        m_camera = camera;
+        UpdateCameraChunk(true);
+    }
+
+    void ChunkManager::SetRenderDistance(int renderDistance, int renderHeight)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_chunkThreadMutex);
+            m_renderDistance = renderDistance;
+            m_renderHeight = renderHeight;
+            m_chunkThreadWake = true;
+        }
+        m_chunkThreadCondition.notify_one();
+    }
+
+    void ChunkManager::SetLodDistance(int distance)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_chunkThreadMutex);
+            m_lodDistance = std::max(distance, 0);
+            m_chunkThreadWake = true;
+        }
+        m_chunkThreadCondition.notify_one();
+    }
+
+    void ChunkManager::UpdateCameraChunk(bool force)
+    {
+        if (!m_camera)
+            return;
+
+        // The camera looks down the view matrix's negative z axis
+        glm::mat4 view = m_camera->GetViewMatrix();
+        glm::vec3 viewDirection = -glm::vec3(view[0][2], view[1][2], view[2][2]);
+
+        // Small turns don't reorder the load queue, so they don't need to wake the chunk thread
+        glm::ivec3 cameraChunk = GetCameraChunkId(m_camera->m_position);
+        bool turned = glm::dot(viewDirection, m_lastViewDirection) < ChunkLoadScheduler::VIEW_DIRECTION_THRESHOLD;
+        if (!force && cameraChunk == m_lastCameraChunk && !turned)
+            return;
+        m_lastCameraChunk = cameraChunk;
+        if (turned)
+            m_lastViewDirection = viewDirection;
+
+        {
+            std::lock_guard<std::mutex> lock(m_chunkThreadMutex);
+            m_cameraChunk = cameraChunk;
+            m_hasCameraChunk = true;
+            m_viewDirection = m_lastViewDirection;
+            m_chunkThreadWake = true;
+        }
+        m_chunkThreadCondition.notify_one();
     }
 
-    inline void StartChunkMeshJob(ThreadPool& pool, std::shared_ptr<ChunkRenderer> renderer, Priority priority = Priority::Medium)
+    void ChunkManager::WakeChunkThread()
     {
-        if (!renderer)
+        {
+            std::lock_guard<std::mutex> lock(m_chunkThreadMutex);
+            m_chunkThreadWake = true;
+        }
+        m_chunkThreadCondition.notify_one();
+    }
+
+    inline void StartChunkMeshJob(ChunkTaskPool& pool, std::shared_ptr<ChunkRenderer> renderer, Priority priority = Priority::Medium)
+    {
+        // Already waiting for a job that will mesh it
+        if (!renderer || renderer->m_remeshQueued.exchange(true))
             return;
 
         std::weak_ptr<ChunkRenderer> weakChunkPtr = renderer;
         pool.Enqueue([weakChunkPtr] {
             if (auto chunkPtr = weakChunkPtr.lock())
             {
+                if (!chunkPtr->m_remeshQueued.exchange(false))
+                    return;
+
                 uint32_t currentVersion = ++chunkPtr->m_version;
                 std::lock_guard<std::mutex> lock(chunkPtr->m_generationMutex);
                 chunkPtr->GenerateMesh(currentVersion);
@@ -43,41 +175,47 @@ namespace WillowVox
         }, priority);
     }
 
-    inline void StartBatchChunkMeshJob(ThreadPool& pool, std::vector<std::shared_ptr<ChunkRenderer>> renderers, Priority priority = Priority::Medium)
+    inline void StartBatchChunkMeshJob(ChunkTaskPool& pool, std::vector<std::shared_ptr<ChunkRenderer>> renderers, Priority priority = Priority::Medium)
     {
         std::vector<std::weak_ptr<ChunkRenderer>> weakPtrs;
-        std::vector<uint32_t> versions;
         for (auto& r : renderers)
         {
             if (!r)
                 continue;
             
+            // Queued even if a lower priority job is already waiting for the chunk, whichever
+            // job gets to it first meshes it. Meshes already running are out of date, abort them.
+            r->m_remeshQueued = true;
+            ++r->m_version;
             std::weak_ptr<ChunkRenderer> weakChunkPtr = r;
             weakPtrs.push_back(weakChunkPtr);
-            versions.push_back(++r->m_version);
         }
 
-        pool.Enqueue([weakPtrs, versions, priority] {
-            for (size_t i = 0; i < weakPtrs.size(); ++i)
+        if (weakPtrs.empty())
+            return;
+
+        pool.Enqueue([weakPtrs, priority] {
+            std::vector<std::shared_ptr<ChunkRenderer>> meshed;
+            for (auto& weakChunkPtr : weakPtrs)
             {
-                auto& weakChunkPtr = weakPtrs[i];
-                uint32_t currentVersion = versions[i];
                 if (auto chunkPtr = weakChunkPtr.lock())
                 {
+                    if (!chunkPtr->m_remeshQueued.exchange(false))
+                        continue;
+
+                    uint32_t currentVersion = ++chunkPtr->m_version;
                     std::lock_guard<std::mutex> lock(chunkPtr->m_generationMutex);
                     chunkPtr->GenerateMesh(currentVersion, true);
+                    meshed.push_back(chunkPtr);
                 }
             }
 
-            for (auto& weakChunkPtr : weakPtrs)
-            {
-                if (auto chunkPtr = weakChunkPtr.lock())
-                    chunkPtr->MarkDirty();
-            }
+            for (auto& chunkPtr : meshed)
+                chunkPtr->MarkDirty();
         }, priority);
     }
 
-    inline void StartLightingRecalculationJob(ThreadPool& pool, ChunkManager* chunkManager, std::shared_ptr<ChunkData> chunkData, std::shared_ptr<ChunkRenderer> renderer, Priority priority = Priority::Medium)
+    inline void StartLightingRecalculationJob(ChunkTaskPool& pool, ChunkManager* chunkManager, std::shared_ptr<ChunkData> chunkData, std::shared_ptr<ChunkRenderer> renderer, Priority priority = Priority::Medium)
     {
         if (!chunkData)
             return;
@@ -88,177 +226,156 @@ namespace WillowVox
             if (auto chunkDataPtr = weakChunkDataPtr.lock())
             {
                 {
+                    WillowVox::VoxelLighting::RegionLock lock(chunkDataPtr->id, WillowVox::VoxelLighting::AllLight);
                     WillowVox::VoxelLighting::CalculateFullLighting(chunkManager, chunkDataPtr.get());
                 }
                 if (auto chunkRendererPtr = weakChunkRendererPtr.lock())
-                {
-                    uint32_t currentVersion = ++chunkRendererPtr->m_version;
-                    std::lock_guard<std::mutex> lock(chunkRendererPtr->m_generationMutex);
-                    chunkRendererPtr->GenerateMesh(currentVersion);
-                }
+                    chunkManager->RequestRemesh(chunkRendererPtr->m_chunkId);
             }
         }, priority);
     }
 
-    inline void StartLightAddJob(ThreadPool& pool, ChunkManager& chunkManager, std::shared_ptr<ChunkData> chunkData, int x, int y, int z, int lightLevel, Priority priority = Priority::Medium)
+    // Chunks an edit changed, remeshed once every lighting job of the edit has finished so the
+    // new blocks and their light show up in the same mesh
+    struct EditRemesh
+    {
+        std::mutex mutex;
+        std::unordered_set<glm::ivec3> chunks;
+        // Starts at one for the edit itself, which finishes once its jobs are queued
+        std::atomic<int> pendingJobs = 1;
+    };
+
+    inline void FinishEditLightingJob(ChunkManager& chunkManager, EditRemesh& remesh, const std::unordered_set<glm::ivec3>& chunksToRemesh)
+    {
+        {
+            std::lock_guard<std::mutex> lock(remesh.mutex);
+            remesh.chunks.insert(chunksToRemesh.begin(), chunksToRemesh.end());
+        }
+
+        if (--remesh.pendingJobs > 0)
+            return;
+
+        for (auto& chunkId : remesh.chunks)
+            chunkManager.RequestRemesh(chunkId, true);
+    }
+
+    inline void StartLightAddJob(ChunkTaskPool& pool, ChunkManager& chunkManager, std::shared_ptr<ChunkData> chunkData, int x, int y, int z, int lightLevel, std::shared_ptr<EditRemesh> remesh, Priority priority = Priority::Medium)
     {
         if (!chunkData)
             return;
 
+        remesh->pendingJobs++;
         std::weak_ptr<ChunkData> weakChunkDataPtr = chunkData;
-        pool.Enqueue([&chunkManager, weakChunkDataPtr, x, y, z, lightLevel] {
+        pool.Enqueue([&chunkManager, weakChunkDataPtr, x, y, z, lightLevel, remesh] {
+            std::unordered_set<glm::ivec3> chunksToRemesh;
             if (auto chunkDataPtr = weakChunkDataPtr.lock())
             {
-                std::lock_guard<std::mutex> lock(WillowVox::VoxelLighting::lightingMutex);
-                auto chunksToRemesh = WillowVox::VoxelLighting::AddLightEmitter(&chunkManager, chunkDataPtr.get(), x, y, z, lightLevel);
-
-                // Remesh affected chunks
-                for (auto& chunkId : chunksToRemesh)
-                {
-                    auto renderer = chunkManager.GetChunkRenderer(chunkId);
-                    if (renderer)
-                    {
-                        uint32_t currentVersion = ++renderer->m_version;
-                        std::lock_guard<std::mutex> lock(renderer->m_generationMutex);
-                        renderer->GenerateMesh(currentVersion);
-                    }
-                }
+                WillowVox::VoxelLighting::RegionLock lock(chunkDataPtr->id, WillowVox::VoxelLighting::BlockLight);
+                chunksToRemesh = WillowVox::VoxelLighting::AddLightEmitter(&chunkManager, chunkDataPtr.get(), x, y, z, lightLevel);
             }
+
+            // Remesh affected chunks
+            FinishEditLightingJob(chunkManager, *remesh, chunksToRemesh);
         }, priority);
     }
 
-    inline void StartLightRemovalJob(ThreadPool& pool, ChunkManager& chunkManager, std::shared_ptr<ChunkData> chunkData, int x, int y, int z, Priority priority = Priority::Medium)
+    inline void StartLightRemovalJob(ChunkTaskPool& pool, ChunkManager& chunkManager, std::shared_ptr<ChunkData> chunkData, int x, int y, int z, std::shared_ptr<EditRemesh> remesh, Priority priority = Priority::Medium)
     {
         if (!chunkData)
             return;
 
+        remesh->pendingJobs++;
         std::weak_ptr<ChunkData> weakChunkDataPtr = chunkData;
-        pool.Enqueue([&chunkManager, weakChunkDataPtr, x, y, z] {
+        pool.Enqueue([&chunkManager, weakChunkDataPtr, x, y, z, remesh] {
+            std::unordered_set<glm::ivec3> chunksToRemesh;
             if (auto chunkDataPtr = weakChunkDataPtr.lock())
             {
-                std::lock_guard<std::mutex> lock(WillowVox::VoxelLighting::lightingMutex);
-                auto chunksToRemesh = WillowVox::VoxelLighting::RemoveLightEmitter(&chunkManager, chunkDataPtr.get(), x, y, z);
-
-                // Remesh affected chunks
-                for (auto& chunkId : chunksToRemesh)
-                {
-                    auto renderer = chunkManager.GetChunkRenderer(chunkId);
-                    if (renderer)
-                    {
-                        uint32_t currentVersion = ++renderer->m_version;
-                        std::lock_guard<std::mutex> lock(renderer->m_generationMutex);
-                        renderer->GenerateMesh(currentVersion);
-                    }
-                }
+                WillowVox::VoxelLighting::RegionLock lock(chunkDataPtr->id, WillowVox::VoxelLighting::BlockLight);
+                chunksToRemesh = WillowVox::VoxelLighting::RemoveLightEmitter(&chunkManager, chunkDataPtr.get(), x, y, z);
             }
+
+            // Remesh affected chunks
+            FinishEditLightingJob(chunkManager, *remesh, chunksToRemesh);
         }, priority);
     }
 
-    inline void StartLightBlockerAddJob(ThreadPool& pool, ChunkManager& chunkManager, std::shared_ptr<ChunkData> chunkData, int x, int y, int z, Priority priority = Priority::Medium)
+    inline void StartLightBlockerAddJob(ChunkTaskPool& pool, ChunkManager& chunkManager, std::shared_ptr<ChunkData> chunkData, int x, int y, int z, std::shared_ptr<EditRemesh> remesh, Priority priority = Priority::Medium)
     {
         if (!chunkData)
             return;
 
+        remesh->pendingJobs++;
         std::weak_ptr<ChunkData> weakChunkDataPtr = chunkData;
-        pool.Enqueue([&chunkManager, weakChunkDataPtr, x, y, z] {
+        pool.Enqueue([&chunkManager, weakChunkDataPtr, x, y, z, remesh] {
+            std::unordered_set<glm::ivec3> chunksToRemesh;
             if (auto chunkDataPtr = weakChunkDataPtr.lock())
             {
-                std::lock_guard<std::mutex> lock(WillowVox::VoxelLighting::lightingMutex);
-                auto chunksToRemesh = WillowVox::VoxelLighting::AddLightBlocker(&chunkManager, chunkDataPtr.get(), x, y, z);
-
-                // Remesh affected chunks
-                for (auto& chunkId : chunksToRemesh)
-                {
-                    auto renderer = chunkManager.GetChunkRenderer(chunkId);
-                    if (renderer)
-                    {
-                        uint32_t currentVersion = ++renderer->m_version;
-                        std::lock_guard<std::mutex> lock(renderer->m_generationMutex);
-                        renderer->GenerateMesh(currentVersion);
-                    }
-                }
+                WillowVox::VoxelLighting::RegionLock lock(chunkDataPtr->id, WillowVox::VoxelLighting::BlockLight);
+                chunksToRemesh = WillowVox::VoxelLighting::AddLightBlocker(&chunkManager, chunkDataPtr.get(), x, y, z);
             }
+
+            // Remesh affected chunks
+            FinishEditLightingJob(chunkManager, *remesh, chunksToRemesh);
         }, priority);
     }
 
-    inline void StartLightBlockerRemovalJob(ThreadPool& pool, ChunkManager& chunkManager, std::shared_ptr<ChunkData> chunkData, int x, int y, int z, Priority priority = Priority::Medium)
+    inline void StartLightBlockerRemovalJob(ChunkTaskPool& pool, ChunkManager& chunkManager, std::shared_ptr<ChunkData> chunkData, int x, int y, int z, std::shared_ptr<EditRemesh> remesh, Priority priority = Priority::Medium)
     {
         if (!chunkData)
             return;
 
+        remesh->pendingJobs++;
         std::weak_ptr<ChunkData> weakChunkDataPtr = chunkData;
-        pool.Enqueue([&chunkManager, weakChunkDataPtr, x, y, z] {
+        pool.Enqueue([&chunkManager, weakChunkDataPtr, x, y, z, remesh] {
+            std::unordered_set<glm::ivec3> chunksToRemesh;
             if (auto chunkDataPtr = weakChunkDataPtr.lock())
             {
-                std::lock_guard<std::mutex> lock(WillowVox::VoxelLighting::lightingMutex);
-                auto chunksToRemesh = WillowVox::VoxelLighting::RemoveLightBlocker(&chunkManager, chunkDataPtr.get(), x, y, z);
-
-                // Remesh affected chunks
-                for (auto& chunkId : chunksToRemesh)
-                {
-                    auto renderer = chunkManager.GetChunkRenderer(chunkId);
-                    if (renderer)
-                    {
-                        uint32_t currentVersion = ++renderer->m_version;
-                        std::lock_guard<std::mutex> lock(renderer->m_generationMutex);
-                        renderer->GenerateMesh(currentVersion);
-                    }
-                }
+                WillowVox::VoxelLighting::RegionLock lock(chunkDataPtr->id, WillowVox::VoxelLighting::BlockLight);
+                chunksToRemesh = WillowVox::VoxelLighting::RemoveLightBlocker(&chunkManager, chunkDataPtr.get(), x, y, z);
             }
+
+            // Remesh affected chunks
+            FinishEditLightingJob(chunkManager, *remesh, chunksToRemesh);
         }, priority);
     }
 
-    inline void StartSkyLightBlockerAddJob(ThreadPool& pool, ChunkManager& chunkManager, std::shared_ptr<ChunkData> chunkData, int x, int y, int z, Priority priority = Priority::Medium)
+    inline void StartSkyLightBlockerAddJob(ChunkTaskPool& pool, ChunkManager& chunkManager, std::shared_ptr<ChunkData> chunkData, int x, int y, int z, std::shared_ptr<EditRemesh> remesh, Priority priority = Priority::Medium)
     {
         if (!chunkData)
             return;
 
+        remesh->pendingJobs++;
         std::weak_ptr<ChunkData> weakChunkDataPtr = chunkData;
-        pool.Enqueue([&chunkManager, weakChunkDataPtr, x, y, z] {
+        pool.Enqueue([&chunkManager, weakChunkDataPtr, x, y, z, remesh] {
+            std::unordered_set<glm::ivec3> chunksToRemesh;
             if (auto chunkDataPtr = weakChunkDataPtr.lock())
             {
-                std::lock_guard<std::mutex> lock(WillowVox::VoxelLighting::skyLightingMutex);
-                auto chunksToRemesh = WillowVox::VoxelLighting::AddSkyLightBlocker(&chunkManager, chunkDataPtr.get(), x, y, z);
-
-                // Remesh affected chunks
-                for (auto& chunkId : chunksToRemesh)
-                {
-                    auto renderer = chunkManager.GetChunkRenderer(chunkId);
-                    if (renderer)
-                    {
-                        uint32_t currentVersion = ++renderer->m_version;
-                        std::lock_guard<std::mutex> lock(renderer->m_generationMutex);
-                        renderer->GenerateMesh(currentVersion);
-                    }
-                }
+                WillowVox::VoxelLighting::RegionLock lock(chunkDataPtr->id, WillowVox::VoxelLighting::SkyLight);
+                chunksToRemesh = WillowVox::VoxelLighting::AddSkyLightBlocker(&chunkManager, chunkDataPtr.get(), x, y, z);
             }
+
+            // Remesh affected chunks
+            FinishEditLightingJob(chunkManager, *remesh, chunksToRemesh);
         }, priority);
     }
 
-    inline void StartSkyLightBlockerRemovalJob(ThreadPool& pool, ChunkManager& chunkManager, std::shared_ptr<ChunkData> chunkData, int x, int y, int z, Priority priority = Priority::Medium)
+    inline void StartSkyLightBlockerRemovalJob(ChunkTaskPool& pool, ChunkManager& chunkManager, std::shared_ptr<ChunkData> chunkData, int x, int y, int z, std::shared_ptr<EditRemesh> remesh, Priority priority = Priority::Medium)
     {
         if (!chunkData)
             return;
 
+        remesh->pendingJobs++;
         std::weak_ptr<ChunkData> weakChunkDataPtr = chunkData;
-        pool.Enqueue([&chunkManager, weakChunkDataPtr, x, y, z] {
+        pool.Enqueue([&chunkManager, weakChunkDataPtr, x, y, z, remesh] {
+            std::unordered_set<glm::ivec3> chunksToRemesh;
             if (auto chunkDataPtr = weakChunkDataPtr.lock())
             {
-                std::lock_guard<std::mutex> lock(WillowVox::VoxelLighting::skyLightingMutex);
-                auto chunksToRemesh = WillowVox::VoxelLighting::RemoveSkyLightBlocker(&chunkManager, chunkDataPtr.get(), x, y, z);
-
-                // Remesh affected chunks
-                for (auto& chunkId : chunksToRemesh)
-                {
-                    auto renderer = chunkManager.GetChunkRenderer(chunkId);
-                    if (renderer)
-                    {
-                        uint32_t currentVersion = ++renderer->m_version;
-                        std::lock_guard<std::mutex> lock(renderer->m_generationMutex);
-                        renderer->GenerateMesh(currentVersion);
-                    }
-                }
+                WillowVox::VoxelLighting::RegionLock lock(chunkDataPtr->id, WillowVox::VoxelLighting::SkyLight);
+                chunksToRemesh = WillowVox::VoxelLighting::RemoveSkyLightBlocker(&chunkManager, chunkDataPtr.get(), x, y, z);
             }
+
+            // Remesh affected chunks
+            FinishEditLightingJob(chunkManager, *remesh, chunksToRemesh);
         }, priority);
     }
 
@@ -272,74 +389,336 @@ namespace WillowVox
         {
             BlockId oldBlockId = chunk->Get(localPos.x, localPos.y, localPos.z);
             chunk->Set(localPos.x, localPos.y, localPos.z, blockId);
+            RecordEdit(chunkId, localPos, oldBlockId, blockId);
 
             static BlockRegistry& blockRegistry = BlockRegistry::GetInstance();
             auto& block = blockRegistry.GetBlock(blockId);
 
-            // Get vector of chunks to remesh
-            std::vector<std::shared_ptr<ChunkRenderer>> chunksToRemesh;
-            chunksToRemesh.push_back(GetChunkRenderer(chunkId));
-
-            // Remesh surrounding chunks if necessary
+            // Remesh the chunk, and surrounding chunks if necessary
+            // Held back until the lighting jobs below finish, which remesh these along with the
+            // chunks their light reached
+            std::unordered_set<glm::ivec3> chunksToRemesh = { chunkId };
             if (localPos.x == 0)
-            {
-                auto renderer = GetChunkRenderer(chunkId.x - 1, chunkId.y, chunkId.z);
-                chunksToRemesh.push_back(renderer);
-            }
+                chunksToRemesh.insert({ chunkId.x - 1, chunkId.y, chunkId.z });
             else if (localPos.x == CHUNK_SIZE - 1)
-            {
-                auto renderer = GetChunkRenderer(chunkId.x + 1, chunkId.y, chunkId.z);
-                chunksToRemesh.push_back(renderer);
-            }
+                chunksToRemesh.insert({ chunkId.x + 1, chunkId.y, chunkId.z });
             if (localPos.y == 0)
-            {
-                auto renderer = GetChunkRenderer(chunkId.x, chunkId.y - 1, chunkId.z);
-                chunksToRemesh.push_back(renderer);
-            }
+                chunksToRemesh.insert({ chunkId.x, chunkId.y - 1, chunkId.z });
             else if (localPos.y == CHUNK_SIZE - 1)
-            {
-                auto renderer = GetChunkRenderer(chunkId.x, chunkId.y + 1, chunkId.z);
-                chunksToRemesh.push_back(renderer);
-            }
+                chunksToRemesh.insert({ chunkId.x, chunkId.y + 1, chunkId.z });
             if (localPos.z == 0)
-            {
-                auto renderer = GetChunkRenderer(chunkId.x, chunkId.y, chunkId.z - 1);
-                chunksToRemesh.push_back(renderer);
-            }
+                chunksToRemesh.insert({ chunkId.x, chunkId.y, chunkId.z - 1 });
             else if (localPos.z == CHUNK_SIZE - 1)
-            {
-                auto renderer = GetChunkRenderer(chunkId.x, chunkId.y, chunkId.z + 1);
-                chunksToRemesh.push_back(renderer);
-            }
-
-            // Start remesh job
-            StartBatchChunkMeshJob(m_chunkThreadPool, chunksToRemesh, Priority::High);
+                chunksToRemesh.insert({ chunkId.x, chunkId.y, chunkId.z + 1 });
+            WakeChunkThread();
 
             // Handle lighting updates
+            auto remesh = std::make_shared<EditRemesh>();
             if (block.lightEmitter)
             {
-                StartLightAddJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, block.lightLevel, Priority::High);
-                StartSkyLightBlockerAddJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, Priority::High);
+                StartLightAddJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, block.lightLevel, remesh, Priority::High);
+                StartSkyLightBlockerAddJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, remesh, Priority::High);
             }
             else if (blockId == 0)
             {
                 if (blockRegistry.GetBlock(oldBlockId).lightEmitter)
                 {
-                    StartLightRemovalJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, Priority::High);
-                    StartSkyLightBlockerRemovalJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, Priority::High);
+                    StartLightRemovalJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, remesh, Priority::High);
+                    StartSkyLightBlockerRemovalJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, remesh, Priority::High);
                 }
                 else
                 {
-                    StartLightBlockerRemovalJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, Priority::High);
-                    StartSkyLightBlockerRemovalJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, Priority::High);
+                    StartLightBlockerRemovalJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, remesh, Priority::High);
+                    StartSkyLightBlockerRemovalJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, remesh, Priority::High);
                 }
             }
             else
             {
-                StartLightBlockerAddJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, Priority::High);
-                StartSkyLightBlockerAddJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, Priority::High);
+                StartLightBlockerAddJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, remesh, Priority::High);
+                StartSkyLightBlockerAddJob(m_chunkThreadPool, *this, chunk, localPos.x, localPos.y, localPos.z, remesh, Priority::High);
             }
+
+            // Remeshes right away if no job is still running
+            FinishEditLightingJob(*this, *remesh, chunksToRemesh);
+        }
+    }
+
+    void ChunkManager::SetEditJournalEnabled(bool enabled)
+    {
+        m_editJournalEnabled = enabled;
+        if (!enabled)
+        {
+            std::lock_guard<std::mutex> lock(m_editJournalMutex);
+            m_editJournals.clear();
+        }
+    }
+
+    void ChunkManager::RecordEdit(const glm::ivec3& chunkId, const glm::ivec3& localPos, BlockId oldId, BlockId newId)
+    {
+        if (!m_editJournalEnabled)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_editJournalMutex);
+        m_editJournals[chunkId].Record(ChunkData::Index(localPos.x, localPos.y, localPos.z), oldId, newId, m_editTick);
+    }
+
+    void ChunkManager::DrainEdits(std::vector<ChunkEdits>& out)
+    {
+        std::lock_guard<std::mutex> lock(m_editJournalMutex);
+        for (auto& [chunkId, journal] : m_editJournals)
+        {
+            if (journal.Empty())
+                continue;
+
+            ChunkEdits& chunkEdits = out.emplace_back();
+            chunkEdits.chunkId = chunkId;
+            journal.Drain(chunkEdits.edits);
+        }
+        m_editJournals.clear();
+    }
+
+    struct ChunkManager::BulkEdit
+    {
+        // Keeps the edited chunks alive until they are relit
+        std::vector<std::shared_ptr<ChunkData>> chunks;
+        std::vector<VoxelLighting::LightChange> lightChanges;
+        // Edited chunks and the neighbors of edited borders
+        std::unordered_set<glm::ivec3> chunksToRemesh;
+    };
+
+    void ChunkManager::SetBlocks(const std::vector<BlockChange>& changes)
+    {
+        // Group the writes by chunk, keeping their order so the last write to a block wins
+        std::unordered_map<glm::ivec3, std::vector<BlockChange>> writesByChunk;
+        for (auto& change : changes)
+        {
+            auto chunkId = BlockToChunkId(change.pos.x, change.pos.y, change.pos.z);
+            auto localPos = BlockToLocalChunkPos(change.pos.x, change.pos.y, change.pos.z, chunkId);
+            writesByChunk[chunkId].push_back({ localPos, change.blockId });
+        }
+
+        auto edit = std::make_shared<BulkEdit>();
+        for (auto& [chunkId, writes] : writesByChunk)
+        {
+            if (auto chunk = GetChunkData(chunkId))
+                WriteChunkBlocks(*edit, chunk, writes);
         }
+        FinishBulkEdit(edit);
+    }
+
+    void ChunkManager::FillBox(const glm::ivec3& min, const glm::ivec3& max, BlockId blockId)
+    {
+        EditBlocks(min, max, [blockId](const glm::ivec3&, BlockId& outBlockId) {
+            outBlockId = blockId;
+            return true;
+        });
+    }
+
+    void ChunkManager::FillSphere(const glm::vec3& center, float radius, BlockId blockId)
+    {
+        glm::ivec3 min = glm::floor(center - radius);
+        glm::ivec3 max = glm::floor(center + radius);
+        EditBlocks(min, max, [center, radius, blockId](const glm::ivec3& pos, BlockId& outBlockId) {
+            glm::vec3 offset = glm::vec3(pos) + 0.5f - center;
+            if (glm::dot(offset, offset) > radius * radius)
+                return false;
+
+            outBlockId = blockId;
+            return true;
+        });
+    }
+
+    ChunkManager::BlockRegion ChunkManager::CopyRegion(const glm::ivec3& min, const glm::ivec3& max)
+    {
+        BlockRegion region;
+        if (max.x < min.x || max.y < min.y || max.z < min.z)
+            return region;
+
+        region.size = max - min + 1;
+        region.blocks.assign((size_t)region.size.x * region.size.y * region.size.z, 0);
+
+        glm::ivec3 minChunk = BlockToChunkId(min.x, min.y, min.z);
+        glm::ivec3 maxChunk = BlockToChunkId(max.x, max.y, max.z);
+        for (int chunkZ = minChunk.z; chunkZ <= maxChunk.z; chunkZ++)
+        {
+            for (int chunkX = minChunk.x; chunkX <= maxChunk.x; chunkX++)
+            {
+                for (int chunkY = minChunk.y; chunkY <= maxChunk.y; chunkY++)
+                {
+                    auto chunk = GetChunkData(chunkX, chunkY, chunkZ);
+                    if (!chunk)
+                        continue;
+
+                    glm::ivec3 chunkOrigin = glm::ivec3(chunkX, chunkY, chunkZ) * CHUNK_SIZE;
+                    glm::ivec3 from = glm::max(min - chunkOrigin, glm::ivec3(0));
+                    glm::ivec3 to = glm::min(max - chunkOrigin, glm::ivec3(CHUNK_SIZE - 1));
+                    for (int z = from.z; z <= to.z; z++)
+                    {
+                        for (int x = from.x; x <= to.x; x++)
+                        {
+                            for (int y = from.y; y <= to.y; y++)
+                            {
+                                glm::ivec3 regionPos = chunkOrigin + glm::ivec3(x, y, z) - min;
+                                region.blocks[region.Index(regionPos.x, regionPos.y, regionPos.z)] = chunk->Get(x, y, z);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        return region;
+    }
+
+    void ChunkManager::PasteRegion(const BlockRegion& region, const glm::ivec3& origin, bool skipAir)
+    {
+        if (region.blocks.empty())
+            return;
+
+        EditBlocks(origin, origin + region.size - 1, [&region, origin, skipAir](const glm::ivec3& pos, BlockId& outBlockId) {
+            glm::ivec3 regionPos = pos - origin;
+            outBlockId = region.blocks[region.Index(regionPos.x, regionPos.y, regionPos.z)];
+            return !skipAir || outBlockId != 0;
+        });
+    }
+
+    void ChunkManager::EditBlocks(const glm::ivec3& min, const glm::ivec3& max, const std::function<bool(const glm::ivec3&, BlockId&)>& getBlock)
+    {
+        auto edit = std::make_shared<BulkEdit>();
+        std::vector<BlockChange> writes;
+
+        glm::ivec3 minChunk = BlockToChunkId(min.x, min.y, min.z);
+        glm::ivec3 maxChunk = BlockToChunkId(max.x, max.y, max.z);
+        for (int chunkZ = minChunk.z; chunkZ <= maxChunk.z; chunkZ++)
+        {
+            for (int chunkX = minChunk.x; chunkX <= maxChunk.x; chunkX++)
+            {
+                for (int chunkY = minChunk.y; chunkY <= maxChunk.y; chunkY++)
+                {
+                    auto chunk = GetChunkData(chunkX, chunkY, chunkZ);
+                    if (!chunk)
+                        continue;
+
+                    glm::ivec3 chunkOrigin = glm::ivec3(chunkX, chunkY, chunkZ) * CHUNK_SIZE;
+                    glm::ivec3 from = glm::max(min - chunkOrigin, glm::ivec3(0));
+                    glm::ivec3 to = glm::min(max - chunkOrigin, glm::ivec3(CHUNK_SIZE - 1));
+
+                    writes.clear();
+                    for (int z = from.z; z <= to.z; z++)
+                    {
+                        for (int x = from.x; x <= to.x; x++)
+                        {
+                            for (int y = from.y; y <= to.y; y++)
+                            {
+                                glm::ivec3 localPos = { x, y, z };
+                                BlockId blockId;
+                                if (getBlock(chunkOrigin + localPos, blockId))
+                                    writes.push_back({ localPos, blockId });
+                            }
+                        }
+                    }
+
+                    WriteChunkBlocks(*edit, chunk, writes);
+                }
+            }
+        }
+
+        FinishBulkEdit(edit);
+    }
+
+    void ChunkManager::WriteChunkBlocks(BulkEdit& edit, const std::shared_ptr<ChunkData>& chunk, const std::vector<BlockChange>& writes)
+    {
+        static BlockRegistry& blockRegistry = BlockRegistry::GetInstance();
+
+        size_t firstChange = edit.lightChanges.size();
+        std::vector<BlockEdit> journalEdits;
+        // Faces of the chunk that had a border block changed, in NEIGHBOR_OFFSETS order
+        uint8_t borderFaces = 0;
+        for (auto& write : writes)
+        {
+            const glm::ivec3& localPos = write.pos;
+            BlockId oldBlockId = chunk->Get(localPos.x, localPos.y, localPos.z);
+            if (oldBlockId == write.blockId)
+                continue;
+
+            chunk->Set(localPos.x, localPos.y, localPos.z, write.blockId);
+            if (m_editJournalEnabled)
+                journalEdits.push_back({ (uint16_t)ChunkData::Index(localPos.x, localPos.y, localPos.z), oldBlockId, write.blockId, 0 });
+
+            auto& block = blockRegistry.GetBlock(write.blockId);
+            edit.lightChanges.push_back({ chunk.get(), localPos.x, localPos.y, localPos.z, block.lightEmitter ? block.lightLevel : 0 });
+
+            if (localPos.z == CHUNK_SIZE - 1) borderFaces |= 1 << 0;
+            if (localPos.z == 0) borderFaces |= 1 << 1;
+            if (localPos.x == CHUNK_SIZE - 1) borderFaces |= 1 << 2;
+            if (localPos.x == 0) borderFaces |= 1 << 3;
+            if (localPos.y == CHUNK_SIZE - 1) borderFaces |= 1 << 4;
+            if (localPos.y == 0) borderFaces |= 1 << 5;
+        }
+
+        if (edit.lightChanges.size() == firstChange)
+            return;
+
+        edit.chunks.push_back(chunk);
+        edit.chunksToRemesh.insert(chunk->id);
+        for (int face = 0; face < 6; face++)
+        {
+            if (borderFaces & (1 << face))
+                edit.chunksToRemesh.insert(chunk->id + NEIGHBOR_OFFSETS[face]);
+        }
+
+        if (!journalEdits.empty())
+        {
+            std::lock_guard<std::mutex> lock(m_editJournalMutex);
+            auto& journal = m_editJournals[chunk->id];
+            for (auto& journalEdit : journalEdits)
+                journal.Record(journalEdit.index, journalEdit.oldId, journalEdit.newId, m_editTick);
+        }
+    }
+
+    void ChunkManager::FinishBulkEdit(std::shared_ptr<BulkEdit> edit)
+    {
+        if (edit->lightChanges.empty())
+            return;
+
+        m_chunkThreadPool.Enqueue([this, edit] {
+            // Light spreads into neighboring chunks, so the update locks the columns around every edited chunk
+            {
+                std::vector<glm::ivec3> chunkIds;
+                for (auto& chunk : edit->chunks)
+                    chunkIds.push_back(chunk->id);
+                WillowVox::VoxelLighting::RegionLock lock(chunkIds, WillowVox::VoxelLighting::AllLight);
+                auto litChunks = WillowVox::VoxelLighting::UpdateLighting(this, edit->lightChanges);
+                edit->chunksToRemesh.insert(litChunks.begin(), litChunks.end());
+            }
+
+            for (auto& chunkId : edit->chunksToRemesh)
+                RequestRemesh(chunkId, true);
+        }, Priority::High);
+        WakeChunkThread();
+    }
+
+    void ChunkManager::RequestRemesh(const glm::ivec3& id, bool urgent)
+    {
+        m_remeshScheduler.Request(id, urgent);
+    }
+
+    void ChunkManager::FlushRemeshes()
+    {
+        m_urgentRemeshes.clear();
+        m_backgroundRemeshes.clear();
+        m_remeshScheduler.Take(m_urgentRemeshes, m_backgroundRemeshes);
+
+        if (!m_urgentRemeshes.empty())
+        {
+            std::vector<std::shared_ptr<ChunkRenderer>> chunksToRemesh;
+            for (auto& id : m_urgentRemeshes)
+                chunksToRemesh.push_back(GetChunkRenderer(id));
+            StartBatchChunkMeshJob(m_chunkThreadPool, chunksToRemesh, Priority::High);
+        }
+
+        for (auto& id : m_backgroundRemeshes)
+            StartChunkMeshJob(m_chunkThreadPool, GetChunkRenderer(id));
     }
 
     std::shared_ptr<ChunkData> ChunkManager::GetChunkData(int x, int y, int z)
@@ -368,20 +747,12 @@ namespace WillowVox
 
     std::shared_ptr<ChunkData> ChunkManager::GetChunkData(const glm::ivec3& id)
     {
-        std::shared_lock<std::shared_mutex> chunkDataLock(m_chunkDataMutex);
-        if (m_chunkData.find(id) != m_chunkData.end())
-            return m_chunkData[id];
-
-        return nullptr;
+        return m_chunkData.Get(id);
     }
 
     std::shared_ptr<ChunkRenderer> ChunkManager::GetChunkRenderer(const glm::ivec3& id)
     {
-        std::shared_lock<std::shared_mutex> chunkRendererLock(m_chunkRendererMutex);
-        if (m_chunkRenderers.find(id) != m_chunkRenderers.end())
-            return m_chunkRenderers[id];
-
-        return nullptr;
+        return m_chunkRenderers.Get(id);
     }
 
     BlockId ChunkManager::GetBlockId(float x, float y, float z)
@@ -399,36 +770,228 @@ namespace WillowVox
 
     void ChunkManager::Render()
     {
+        if (!m_camera)
+        {
+            RenderChunks(nullptr);
+            return;
+        }
+
+        Render(m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix());
+    }
+
+    void ChunkManager::Render(const glm::mat4& viewProjection)
+    {
+        Frustum frustum = Frustum::FromMatrix(viewProjection);
+        RenderChunks(&frustum);
+    }
+
+    void ChunkManager::RenderChunks(const Frustum* frustum)
+    {
+        // Wake the chunk thread when the camera crosses into another chunk or turns
+        UpdateCameraChunk(false);
+        FlushRemeshes();
+
         {
             std::lock_guard<std::mutex> lock(m_chunkRendererDeletionMutex);
             while (!m_chunkRendererDeletionQueue.empty())
             {
+                if (m_batchRenderer)
+                    m_batchRenderer->RemoveChunk(m_chunkRendererDeletionQueue.front().get());
                 m_chunkRendererDeletionQueue.pop();
             }
         }
 
-        m_chunkShader->Bind();
+        if (m_batchRenderer)
+        {
+            m_chunkBatchShader->Bind();
+            m_batchRenderer->BeginFrame();
+        }
+        else
+        {
+            m_chunkShader->Bind();
+        }
         m_chunkTexture->BindTexture(Texture::TEX00);
+
+#ifdef DEBUG_MODE
+        m_chunksRendered = 0;
+#endif
+
+        if (ChunkRenderer::IsCaveCullingEnabled() && m_camera)
         {
-            std::shared_lock<std::shared_mutex> lock(m_chunkRendererMutex);
-            for (auto [id, chunk] : m_chunkRenderers)
+            RenderCaveCulled(frustum);
+        }
+        else
+        {
+            m_chunkRenderers.ForEach([&](const glm::ivec3& id, const std::shared_ptr<ChunkRenderer>& chunk) {
+                if (IsChunkInFrustum(frustum, id))
+                    DrawChunk(*chunk);
+            });
+        }
+
+        if (m_batchRenderer)
+        {
+            m_batchRenderer->Draw();
+
+            // The batch renderer couldn't create its buffers, draw chunks one at a time from the next frame on
+            if (!ChunkBatchRenderer::IsSupported())
+                SetBatchedRendering(false);
+        }
+    }
+
+    void ChunkManager::DrawChunk(ChunkRenderer& chunk)
+    {
+        if (m_batchRenderer)
+            m_batchRenderer->AddChunk(chunk);
+        else
+            chunk.Render();
+
+#ifdef DEBUG_MODE
+        m_chunksRendered++;
+#endif
+    }
+
+    void ChunkManager::SetBatchedRendering(bool enabled, uint32_t uploadBudget)
+    {
+        if (enabled == (m_batchRenderer != nullptr))
+            return;
+
+        if (enabled)
+        {
+            if (!ChunkBatchRenderer::IsSupported())
             {
-                chunk->Render();
+                Logger::Warn("Batched chunk rendering is not supported, drawing chunks one at a time");
+                return;
             }
+
+            m_chunkBatchShader = AssetManager::GetInstance().GetAsset<Shader>("chunk_batch_shader");
+            m_batchRenderer = std::make_unique<ChunkBatchRenderer>(uploadBudget);
         }
+        else
+        {
+            m_batchRenderer.reset();
+        }
+
+        // Meshes already uploaded by one path have to be uploaded again by the other
+        m_chunkRenderers.ForEach([](const glm::ivec3& id, const std::shared_ptr<ChunkRenderer>& chunk) {
+            chunk->MarkDirty();
+        });
     }
 
-    std::shared_ptr<ChunkData> ChunkManager::GetOrGenerateChunkData(const glm::ivec3& id)
+    bool ChunkManager::IsChunkInFrustum(const Frustum* frustum, const glm::ivec3& id)
     {
-        // Get chunk data if it already exists
+        if (!frustum)
+            return true;
+
+        glm::vec3 min = glm::vec3(id * CHUNK_SIZE);
+        return frustum->IntersectsBox(min, min + glm::vec3((float)CHUNK_SIZE));
+    }
+
+    int ChunkManager::GetChunkLod(const glm::ivec3& id, const glm::ivec3& center, int lodDistance)
+    {
+        if (lodDistance <= 0)
+            return 0;
+
+        glm::ivec3 offset = glm::abs(id - center);
+        int distance = std::max({ offset.x, offset.y, offset.z });
+        int level = 0;
+        while (level < ChunkRenderer::MAX_LOD && distance >= lodDistance << level)
+            level++;
+        return level;
+    }
+
+    bool ChunkManager::UpdateChunkLod(ChunkRenderer& chunk, const glm::ivec3& center, int lodDistance)
+    {
+        int level = GetChunkLod(chunk.m_chunkId, center, lodDistance);
+
+        // Borders facing a chunk at another level keep their faces, so the levels don't leave gaps
+        uint8_t seamFaces = 0;
+        for (int face = 0; face < 6; face++)
+        {
+            if (GetChunkLod(chunk.m_chunkId + NEIGHBOR_OFFSETS[face], center, lodDistance) != level)
+                seamFaces |= 1 << face;
+        }
+
+        if (level == chunk.GetLod() && seamFaces == chunk.GetLodSeams())
+            return false;
+
+        chunk.SetLod(level, seamFaces);
+        return true;
+    }
+
+    void ChunkManager::UpdateChunkLods(const glm::ivec3& center, int lodDistance)
+    {
+        std::vector<std::shared_ptr<ChunkRenderer>> chunksToRemesh;
+        m_chunkRenderers.ForEach([&](const glm::ivec3& id, const std::shared_ptr<ChunkRenderer>& chunk) {
+            if (UpdateChunkLod(*chunk, center, lodDistance))
+                chunksToRemesh.push_back(chunk);
+        });
+
+        for (auto& chunk : chunksToRemesh)
+            RequestRemesh(chunk->m_chunkId);
+    }
+
+    void ChunkManager::RenderCaveCulled(const Frustum* frustum)
+    {
+        int renderDistance, renderHeight;
         {
-            std::shared_lock<std::shared_mutex> chunkDataLock(m_chunkDataMutex);
-            auto it = m_chunkData.find(id);
-            if (it != m_chunkData.end())
+            std::lock_guard<std::mutex> lock(m_chunkThreadMutex);
+            renderDistance = m_renderDistance;
+            renderHeight = m_renderHeight;
+        }
+
+        glm::ivec3 center = m_lastCameraChunk;
+        glm::ivec3 extents = { renderDistance, renderHeight, renderDistance };
+        glm::ivec3 size = extents * 2 + 1;
+        m_visitedChunks.assign((size_t)size.x * size.y * size.z, false);
+        auto visitedIndex = [&](const glm::ivec3& id) {
+            glm::ivec3 offset = id - center + extents;
+            return offset.y + (size_t)size.y * (offset.x + (size_t)size.x * offset.z);
+        };
+
+        // Breadth first search out from the camera chunk. A chunk is left through a face only if
+        // its open space connects that face to the one it was entered through, and the search
+        // never steps back towards the camera, so chunks sealed off by solid ground are skipped.
+        m_visibilitySearch.clear();
+        m_visibilitySearch.push_back({ center, -1, 0 });
+        m_visitedChunks[visitedIndex(center)] = true;
+
+        for (size_t head = 0; head < m_visibilitySearch.size(); head++)
+        {
+            VisibilityStep step = m_visibilitySearch[head];
+
+            // Chunks that are still loading count as open
+            auto chunk = m_chunkRenderers.Get(step.id);
+            if (chunk)
+                DrawChunk(*chunk);
+
+            for (int face = 0; face < 6; face++)
             {
-                return it->second;
+                if (step.directions >> (face ^ 1) & 1)
+                    continue;
+                if (chunk && step.entryFace >= 0 && !chunk->ConnectsFaces(step.entryFace, face))
+                    continue;
+
+                glm::ivec3 next = step.id + NEIGHBOR_OFFSETS[face];
+                glm::ivec3 offset = glm::abs(next - center);
+                if (offset.x > renderDistance || offset.y > renderHeight || offset.z > renderDistance)
+                    continue;
+
+                size_t index = visitedIndex(next);
+                if (m_visitedChunks[index])
+                    continue;
+                m_visitedChunks[index] = true;
+
+                if (IsChunkInFrustum(frustum, next))
+                    m_visibilitySearch.push_back({ next, face ^ 1, (uint8_t)(step.directions | 1 << face) });
             }
         }
+    }
+
+    std::shared_ptr<ChunkData> ChunkManager::GetOrGenerateChunkData(const glm::ivec3& id)
+    {
+        // Get chunk data if it already exists
+        if (auto data = m_chunkData.Get(id))
+            return data;
 
         // Check if chunk is within world bounds
         if (!((m_worldSizeX == 0 || (id.x >= -m_worldSizeX && id.x <= m_worldSizeX)) &&
@@ -438,155 +1001,267 @@ namespace WillowVox
             return nullptr;
         }
 
-        // Generate new chunk data
-        auto chunkPos = id * CHUNK_SIZE;
+        // Claim the generation, or wait for the load that is already generating this chunk
+        // Finished data is published before its pending entry is removed, so checking the map
+        // again under the pending lock can't miss it
+        std::promise<std::shared_ptr<ChunkData>> promise;
+        {
+            std::unique_lock<std::mutex> pendingLock(m_pendingChunkDataMutex);
+            if (auto data = m_chunkData.Get(id))
+                return data;
 
-        #ifdef DEBUG_MODE
-        auto start = std::chrono::high_resolution_clock::now();
-        #endif
+            auto pending = m_pendingChunkData.find(id);
+            if (pending != m_pendingChunkData.end())
+            {
+                auto future = pending->second;
+                pendingLock.unlock();
+                return future.get();
+            }
+
+            m_pendingChunkData[id] = promise.get_future().share();
+        }
 
         auto data = std::make_shared<ChunkData>(id);
-        m_worldGen->Generate(data.get(), chunkPos);
 
-        #ifdef DEBUG_MODE
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-        m_chunkDataGenerated++;
-        m_avgChunkDataGenTime = m_avgChunkDataGenTime + (duration.count() - m_avgChunkDataGenTime) / std::min(m_chunkDataGenerated, 1);
-        #endif
+        // Saved chunks replace generation
+        if (m_regionStore && m_regionStore->Load(*data))
+        {
+            #ifdef DEBUG_MODE
+            m_chunkDataLoaded++;
+            #endif
+        }
+        else
+        {
+            // Generate new chunk data
+            auto chunkPos = id * CHUNK_SIZE;
+
+            #ifdef DEBUG_MODE
+            auto start = std::chrono::high_resolution_clock::now();
+            #endif
+
+            m_worldGen->Generate(data.get(), chunkPos);
+            data->Compact();
+
+            #ifdef DEBUG_MODE
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+            m_chunkDataGenerated++;
+            m_avgChunkDataGenTime = m_avgChunkDataGenTime + (duration.count() - m_avgChunkDataGenTime) / std::min(m_chunkDataGenerated, 1);
+            #endif
+        }
+        data->SetModified(false);
+
+        // In ring buffer mode the window may have moved away from the chunk, or not be placed yet.
+        // Data that isn't stored would never be saved or evicted, so it isn't handed out.
+        if (!m_chunkData.Set(id, data))
+            data = nullptr;
 
         {
-            std::unique_lock<std::shared_mutex> chunkDataLock(m_chunkDataMutex);
-            m_chunkData[id] = data;
+            std::lock_guard<std::mutex> pendingLock(m_pendingChunkDataMutex);
+            m_pendingChunkData.erase(id);
         }
+        promise.set_value(data);
 
         return data;
     }
 
-    void ChunkManager::ChunkThread()
+    struct ChunkManager::ChunkLoad
     {
-        int prevXChunk = 1000;
-        int prevYChunk = 1000;
-        int prevZChunk = 1000;
+        glm::ivec3 id;
+        std::shared_ptr<ChunkData> data;
+        std::shared_ptr<ChunkData> neighbors[6];
+        std::atomic<int> pendingGenerations = 7;
+        // Set by the chunk thread when the chunk leaves the load range
+        std::atomic<bool> cancelled = false;
+    };
+
+    void ChunkManager::StartChunkLoad(const glm::ivec3& id)
+    {
+        auto load = std::make_shared<ChunkLoad>();
+        load->id = id;
 
-        while (!m_chunkThreadShouldStop)
         {
-            if (!m_camera) continue;
+            std::lock_guard<std::mutex> lock(m_loadingChunksMutex);
+            m_loadingChunks[id] = load;
+        }
 
-            int chunkX = m_camera->m_position.x < 0 ? (m_camera->m_position.x / CHUNK_SIZE) - 1 : m_camera->m_position.x / CHUNK_SIZE;
-            int chunkY = m_camera->m_position.y < 0 ? (m_camera->m_position.y / CHUNK_SIZE) - 1 : m_camera->m_position.y / CHUNK_SIZE;
-            int chunkZ = m_camera->m_position.z < 0 ? (m_camera->m_position.z / CHUNK_SIZE) - 1 : m_camera->m_position.z / CHUNK_SIZE;
+        // Generate the chunk and its neighbors in parallel
+        for (int i = 0; i < 7; i++)
+        {
+            m_chunkThreadPool.Enqueue([this, load, i] {
+                // Cancelled loads skip generation but still count down, so the load finishes normally
+                if (!load->cancelled)
+                {
+                    if (i == 0)
+                        load->data = GetOrGenerateChunkData(load->id);
+                    else
+                        load->neighbors[i - 1] = GetOrGenerateChunkData(load->id + NEIGHBOR_OFFSETS[i - 1]);
+                }
 
-            if (prevXChunk != chunkX || prevYChunk != chunkY || prevZChunk != chunkZ)
-            {
-                prevXChunk = chunkX;
-                prevYChunk = chunkY;
-                prevZChunk = chunkZ;
+                // The last generation to finish moves the load on to lighting
+                if (--load->pendingGenerations == 0)
+                    m_chunkThreadPool.Enqueue([this, load] { LightChunkLoad(load); }, Priority::Medium);
+            }, Priority::Medium);
+        }
+    }
 
-                // Clear queue
-                std::queue<glm::ivec3> newQueue;
-                std::swap(m_chunkQueue, newQueue);
+    void ChunkManager::LightChunkLoad(std::shared_ptr<ChunkLoad> load)
+    {
+        if (!load->data || load->cancelled)
+        {
+            FinishChunkLoad(*load);
+            return;
+        }
 
-                // Generate new queue
-                m_chunkQueue.push({ chunkX, chunkY, chunkZ });
+        // Light spreads into neighboring chunks, so full lighting is serialized with edit jobs around it
+        std::unordered_set<glm::ivec3> chunksToRemesh;
+        {
+            WillowVox::VoxelLighting::RegionLock lock(load->id, WillowVox::VoxelLighting::AllLight);
+            chunksToRemesh = WillowVox::VoxelLighting::CalculateFullLighting(this, load->data.get());
+        }
 
-                for (int r = 0; r < m_renderDistance; r++)
-                {
-                    // Add middle chunks
-                    for (int y = 0; y < m_renderHeight; y++)
-                    {
-                        m_chunkQueue.push({ chunkX,     chunkY + y, chunkZ + r });
-                        m_chunkQueue.push({ chunkX + r, chunkY + y, chunkZ });
-                        m_chunkQueue.push({ chunkX,     chunkY + y, chunkZ - r });
-                        m_chunkQueue.push({ chunkX - r, chunkY + y, chunkZ });
+        for (auto& chunkIdToRemesh : chunksToRemesh)
+        {
+            if (chunkIdToRemesh != load->id)
+                RequestRemesh(chunkIdToRemesh);
+        }
 
-                        if (y > 0)
-                        {
-                            m_chunkQueue.push({ chunkX,     chunkY - y, chunkZ + r });
-                            m_chunkQueue.push({ chunkX + r, chunkY - y, chunkZ });
-                            m_chunkQueue.push({ chunkX,     chunkY - y, chunkZ - r });
-                            m_chunkQueue.push({ chunkX - r, chunkY - y, chunkZ });
-                        }
-                    }
+        m_chunkThreadPool.Enqueue([this, load] { MeshChunkLoad(load); }, Priority::Medium);
+    }
 
-                    // Add edges
-                    for (int e = 1; e < r; e++)
-                    {
-                        for (int y = 0; y <= m_renderHeight; y++)
-                        {
-                            m_chunkQueue.push({ chunkX + e, chunkY + y, chunkZ + r });
-                            m_chunkQueue.push({ chunkX - e, chunkY + y, chunkZ + r });
+    void ChunkManager::MeshChunkLoad(std::shared_ptr<ChunkLoad> load)
+    {
+        if (load->cancelled)
+        {
+            FinishChunkLoad(*load);
+            return;
+        }
 
-                            m_chunkQueue.push({ chunkX + r, chunkY + y, chunkZ + e });
-                            m_chunkQueue.push({ chunkX + r, chunkY + y, chunkZ - e });
+        // Create chunk renderer
+        auto chunk = std::make_shared<ChunkRenderer>(load->data, load->id);
+
+        // Set neighboring chunks
+        chunk->SetSouthData(load->neighbors[0]);
+        chunk->SetNorthData(load->neighbors[1]);
+        chunk->SetEastData(load->neighbors[2]);
+        chunk->SetWestData(load->neighbors[3]);
+        chunk->SetUpData(load->neighbors[4]);
+        chunk->SetDownData(load->neighbors[5]);
+
+        auto getLodCenter = [this](glm::ivec3& center, int& lodDistance) {
+            std::lock_guard<std::mutex> lock(m_chunkThreadMutex);
+            center = m_cameraChunk;
+            lodDistance = m_lodDistance;
+        };
+
+        glm::ivec3 lodCenter;
+        int lodDistance;
+        getLodCenter(lodCenter, lodDistance);
+        UpdateChunkLod(*chunk, lodCenter, lodDistance);
+
+        // Generate chunk mesh data
+        chunk->GenerateMesh();
+
+        // Add chunk to map
+        // Checking for cancellation under the shard lock guarantees a chunk that left the range
+        // while meshing is either dropped here or seen by the chunk thread's next eviction pass
+        bool added = m_chunkRenderers.SetIf(load->id, chunk, [&] { return !load->cancelled; });
+
+        // The camera may have moved while meshing, before the chunk thread could see this chunk
+        getLodCenter(lodCenter, lodDistance);
+        if (added && UpdateChunkLod(*chunk, lodCenter, lodDistance))
+            RequestRemesh(load->id);
+
+        FinishChunkLoad(*load);
+    }
 
-                            m_chunkQueue.push({ chunkX + e, chunkY + y, chunkZ - r });
-                            m_chunkQueue.push({ chunkX - e, chunkY + y, chunkZ - r });
+    void ChunkManager::FinishChunkLoad(const ChunkLoad& load)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_loadingChunksMutex);
+            m_loadingChunks.erase(load.id);
+        }
 
-                            m_chunkQueue.push({ chunkX - r, chunkY + y, chunkZ + e });
-                            m_chunkQueue.push({ chunkX - r, chunkY + y, chunkZ - e });
+        // The pipeline has room for another chunk
+        WakeChunkThread();
+    }
 
-                            if (y > 0)
-                            {
-                                m_chunkQueue.push({ chunkX + e, chunkY - y, chunkZ + r });
-                                m_chunkQueue.push({ chunkX - e, chunkY - y, chunkZ + r });
+    void ChunkManager::ChunkThread()
+    {
+        int prevXChunk = 1000;
+        int prevYChunk = 1000;
+        int prevZChunk = 1000;
+        int prevRenderDistance = 0;
+        int prevRenderHeight = 0;
+        int prevLodDistance = 0;
 
-                                m_chunkQueue.push({ chunkX + r, chunkY - y, chunkZ + e });
-                                m_chunkQueue.push({ chunkX + r, chunkY - y, chunkZ - e });
+        while (true)
+        {
+            // Sleep until the camera, render distance or view direction changes, a load finishes
+            // or the manager shuts down, then snapshot the shared state
+            int chunkX, chunkY, chunkZ;
+            int renderDistance, renderHeight;
+            int lodDistance;
+            {
+                std::unique_lock<std::mutex> lock(m_chunkThreadMutex);
+                m_chunkThreadCondition.wait(lock, [this] { return m_chunkThreadShouldStop || m_chunkThreadWake; });
+                if (m_chunkThreadShouldStop)
+                    break;
+                m_chunkThreadWake = false;
 
-                                m_chunkQueue.push({ chunkX + e, chunkY - y, chunkZ - r });
-                                m_chunkQueue.push({ chunkX - e, chunkY - y, chunkZ - r });
+                if (!m_hasCameraChunk)
+                    continue;
 
-                                m_chunkQueue.push({ chunkX - r, chunkY - y, chunkZ + e });
-                                m_chunkQueue.push({ chunkX - r, chunkY - y, chunkZ - e });
-                            }
-                        }
-                    }
+                chunkX = m_cameraChunk.x;
+                chunkY = m_cameraChunk.y;
+                chunkZ = m_cameraChunk.z;
+                renderDistance = m_renderDistance;
+                renderHeight = m_renderHeight;
+                lodDistance = m_lodDistance;
+                m_loadScheduler.SetViewDirection(m_viewDirection);
+            }
 
-                    // Add corners
-                    for (int y = 0; y <= m_renderHeight; y++)
-                    {
-                        m_chunkQueue.push({ chunkX + r, chunkY + y, chunkZ + r });
-                        m_chunkQueue.push({ chunkX + r, chunkY + y, chunkZ - r });
-                        m_chunkQueue.push({ chunkX - r, chunkY + y, chunkZ + r });
-                        m_chunkQueue.push({ chunkX - r, chunkY + y, chunkZ - r });
+            bool centerChanged = prevXChunk != chunkX || prevYChunk != chunkY || prevZChunk != chunkZ;
+            if (centerChanged || prevRenderDistance != renderDistance || prevRenderHeight != renderHeight)
+            {
+                prevXChunk = chunkX;
+                prevYChunk = chunkY;
+                prevZChunk = chunkZ;
+                prevRenderDistance = renderDistance;
+                prevRenderHeight = renderHeight;
 
-                        if (y > 0)
-                        {
-                            m_chunkQueue.push({ chunkX + r, chunkY - y, chunkZ + r });
-                            m_chunkQueue.push({ chunkX + r, chunkY - y, chunkZ - r });
-                            m_chunkQueue.push({ chunkX - r, chunkY - y, chunkZ + r });
-                            m_chunkQueue.push({ chunkX - r, chunkY - y, chunkZ - r });
-                        }
+                // Queue chunks that entered the range and drop the ones that left it
+                m_loadScheduler.SetCenter({ chunkX, chunkY, chunkZ }, renderDistance, renderHeight);
+
+                // Cancel loads that are no longer needed
+                {
+                    std::lock_guard<std::mutex> lock(m_loadingChunksMutex);
+                    for (auto& [id, load] : m_loadingChunks)
+                    {
+                        if (!m_loadScheduler.InRange(id))
+                            load->cancelled = true;
                     }
                 }
 
-                // Delete chunk renderers out of range
+                if (m_chunkRenderers.IsRingBuffer())
                 {
-                    // Get chunk renderers out of range
+                    // The grids drop everything outside the window. Chunk data keeps a one chunk
+                    // margin for the neighbors of the outermost renderers.
+                    glm::ivec3 center = { chunkX, chunkY, chunkZ };
+                    glm::ivec3 rendererExtents = { renderDistance, renderHeight, renderDistance };
                     std::vector<std::shared_ptr<ChunkRenderer>> chunksToDelete;
+                    std::vector<std::shared_ptr<ChunkData>> chunkDataToDelete;
+                    m_chunkRenderers.Recenter(center, rendererExtents, &chunksToDelete);
 
+                    // Evicted and saved under the pending lock, so a load racing the eviction
+                    // either still finds the data or starts after the save and reads its edits
                     {
-                        std::shared_lock<std::shared_mutex> chunkRenderLock(m_chunkRendererMutex);
-                        for (auto& [id, chunk] : m_chunkRenderers)
-                        {
-                            if (std::abs(id.x - chunkX) > m_renderDistance ||
-                                std::abs(id.y - chunkY) > m_renderHeight ||
-                                std::abs(id.z - chunkZ) > m_renderDistance)
-                            {
-                                chunksToDelete.push_back(chunk);
-                            }
-                        }
+                        std::lock_guard<std::mutex> pendingLock(m_pendingChunkDataMutex);
+                        m_chunkData.Recenter(center, rendererExtents + 1, &chunkDataToDelete);
+                        for (auto& data : chunkDataToDelete)
+                            SaveChunkData(*data);
                     }
 
-                    // Add chunks to deletion queue
-                    {
-                        std::unique_lock<std::shared_mutex> chunkRenderLock(m_chunkRendererMutex);
-                        for (auto& chunk : chunksToDelete)
-                        {
-                            m_chunkRenderers.erase(chunk->m_chunkId);
-                        }
-                    }
                     {
                         std::lock_guard<std::mutex> deleteLock(m_chunkRendererDeletionMutex);
                         for (auto& chunk : chunksToDelete)
@@ -594,95 +1269,138 @@ namespace WillowVox
                             m_chunkRendererDeletionQueue.push(chunk);
                         }
                     }
-                }
 
-                // Delete chunk data out of range
+                    // Lighting that was already running may still be reading the evicted data,
+                    // so it is only released once every lighting region is free
+                    WillowVox::VoxelLighting::RegionLock lightingLock(WillowVox::VoxelLighting::AllLight);
+                    chunkDataToDelete.clear();
+                }
+                else
                 {
-                    // Get chunk data out of range
-                    std::vector<glm::ivec3> chunkDataToDelete;
-
+                    // Delete chunk renderers out of range
                     {
-                        std::shared_lock<std::shared_mutex> chunkDataLock(m_chunkDataMutex);
-                        std::shared_lock<std::shared_mutex> chunkRenderLock(m_chunkRendererMutex);
-                        for (auto& [id, data] : m_chunkData)
+                        // Get chunk renderers out of range
+                        std::vector<std::shared_ptr<ChunkRenderer>> chunksToDelete;
+
+                        m_chunkRenderers.ForEach([&](const glm::ivec3& id, const std::shared_ptr<ChunkRenderer>& chunk) {
+                            if (std::abs(id.x - chunkX) > renderDistance ||
+                                std::abs(id.y - chunkY) > renderHeight ||
+                                std::abs(id.z - chunkZ) > renderDistance)
+                            {
+                                chunksToDelete.push_back(chunk);
+                            }
+                        });
+
+                        // Add chunks to deletion queue
+                        for (auto& chunk : chunksToDelete)
                         {
-                            if (m_chunkRenderers.find(id) == m_chunkRenderers.end() &&
-                                m_chunkRenderers.find({ id.x + 1, id.y, id.z }) == m_chunkRenderers.end() &&
-                                m_chunkRenderers.find({ id.x - 1, id.y, id.z }) == m_chunkRenderers.end() &&
-                                m_chunkRenderers.find({ id.x, id.y + 1, id.z }) == m_chunkRenderers.end() &&
-                                m_chunkRenderers.find({ id.x, id.y - 1, id.z }) == m_chunkRenderers.end() &&
-                                m_chunkRenderers.find({ id.x, id.y, id.z + 1 }) == m_chunkRenderers.end() &&
-                                m_chunkRenderers.find({ id.x, id.y, id.z - 1 }) == m_chunkRenderers.end())
+                            m_chunkRenderers.Erase(chunk->m_chunkId);
+                        }
+                        {
+                            std::lock_guard<std::mutex> deleteLock(m_chunkRendererDeletionMutex);
+                            for (auto& chunk : chunksToDelete)
                             {
-                                chunkDataToDelete.push_back(id);
+                                m_chunkRendererDeletionQueue.push(chunk);
                             }
                         }
                     }
 
                     // Delete chunk data out of range
                     {
-                        std::unique_lock<std::shared_mutex> chunkDataLock(m_chunkDataMutex);
-                        for (auto& id : chunkDataToDelete)
+                        // Get chunk data out of range
+                        std::vector<glm::ivec3> chunkDataToDelete;
+
+                        {
+                            // Holding the loading lock stops loads from finishing while the maps are checked
+                            std::lock_guard<std::mutex> loadingLock(m_loadingChunksMutex);
+                            m_chunkData.ForEach([&](const glm::ivec3& id, const std::shared_ptr<ChunkData>& data) {
+                                // Keep data that an in-flight load has generated or is about to light
+                                bool loading = m_loadingChunks.contains(id);
+                                for (int i = 0; i < 6 && !loading; i++)
+                                    loading = m_loadingChunks.contains(id + NEIGHBOR_OFFSETS[i]);
+                                if (loading)
+                                    return;
+
+                                bool rendered = m_chunkRenderers.Contains(id);
+                                for (int i = 0; i < 6 && !rendered; i++)
+                                    rendered = m_chunkRenderers.Contains(id + NEIGHBOR_OFFSETS[i]);
+                                if (!rendered)
+                                    chunkDataToDelete.push_back(id);
+                            });
+                        }
+
+                        // Delete chunk data out of range, saving it first if it was modified
+                        // Saved before the erase and under the pending lock, so a load racing the
+                        // eviction either still finds the data or starts after the save
+                        std::vector<std::shared_ptr<ChunkData>> evictedData;
+                        {
+                            std::lock_guard<std::mutex> pendingLock(m_pendingChunkDataMutex);
+                            for (auto& id : chunkDataToDelete)
+                            {
+                                auto data = m_chunkData.Get(id);
+                                if (!data)
+                                    continue;
+
+                                SaveChunkData(*data);
+                                m_chunkData.Erase(id);
+                                evictedData.push_back(std::move(data));
+                            }
+                        }
+
+                        // Same as above, running lighting may still be reading the evicted data
+                        if (!evictedData.empty())
                         {
-                            m_chunkData.erase(id);
+                            WillowVox::VoxelLighting::RegionLock lightingLock(WillowVox::VoxelLighting::AllLight);
+                            evictedData.clear();
                         }
                     }
                 }
             }
 
-            if (!m_chunkQueue.empty())
+            // Distance rings move with the camera chunk
+            if (lodDistance != prevLodDistance || (centerChanged && lodDistance > 0))
             {
-                auto id = m_chunkQueue.front();
-                m_chunkQueue.pop();
+                prevLodDistance = lodDistance;
+                UpdateChunkLods({ chunkX, chunkY, chunkZ }, lodDistance);
+            }
+
+            // Hand chunks to the pipeline while it has room, so the priority order is kept
+            std::vector<glm::ivec3> deferred;
+            while (!m_loadScheduler.Empty())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_loadingChunksMutex);
+                    if ((int)m_loadingChunks.size() >= m_maxChunksInFlight)
+                        break;
+                }
+
+                glm::ivec3 id;
+                if (!m_loadScheduler.Pop(id))
+                    break;
 
                 if (!((m_worldSizeX == 0 || (id.x >= -m_worldSizeX && id.x <= m_worldSizeX)) &&
                     (m_worldMinY == 0 || id.y >= -m_worldMinY) && (m_worldMaxY == 0 || id.y <= m_worldMaxY) &&
                     (m_worldSizeZ == 0 || (id.z >= -m_worldSizeZ && id.z <= m_worldSizeZ))))
                     continue;
 
+                if (m_chunkRenderers.Contains(id))
+                    continue;
                 {
-                    std::shared_lock<std::shared_mutex> chunkRendererLock(m_chunkRendererMutex);
-                    if (m_chunkRenderers.find(id) != m_chunkRenderers.end())
-                        continue;
-                }
-
-                // Create chunk data
-                auto data = GetOrGenerateChunkData(id);
-                std::unordered_set<glm::ivec3> chunksToRemesh;
-                chunksToRemesh = WillowVox::VoxelLighting::CalculateFullLighting(this, m_chunkData[id].get());
-
-                // Create chunk renderer
-                auto chunk = std::make_shared<ChunkRenderer>(m_chunkData[id], id);
-
-                // Set neighboring chunks
-                chunk->SetSouthData(GetOrGenerateChunkData({ id.x, id.y, id.z + 1 }));
-                chunk->SetNorthData(GetOrGenerateChunkData({ id.x, id.y, id.z - 1 }));
-                chunk->SetEastData(GetOrGenerateChunkData({ id.x + 1, id.y, id.z }));
-                chunk->SetWestData(GetOrGenerateChunkData({ id.x - 1, id.y, id.z }));
-                chunk->SetUpData(GetOrGenerateChunkData({ id.x, id.y + 1, id.z }));
-                chunk->SetDownData(GetOrGenerateChunkData({ id.x, id.y - 1, id.z }));
-
-                // Generate chunk mesh data
-                chunk->GenerateMesh();
-                for (auto& chunkIdToRemesh : chunksToRemesh)
-                {
-                    auto rendererToRemesh = GetChunkRenderer(chunkIdToRemesh);
-                    if (rendererToRemesh)
+                    // A cancelled load of this chunk is still winding down, try again later
+                    std::lock_guard<std::mutex> lock(m_loadingChunksMutex);
+                    if (m_loadingChunks.contains(id))
                     {
-                        uint32_t currentVersion = ++rendererToRemesh->m_version;
-                        std::lock_guard<std::mutex> lock(rendererToRemesh->m_generationMutex);
-                        rendererToRemesh->GenerateMesh(currentVersion);
+                        deferred.push_back(id);
+                        continue;
                     }
                 }
 
-                // Add chunk to map
-                {
-                    std::unique_lock<std::shared_mutex> lock(m_chunkRendererMutex);
-                    m_chunkRenderers[id] = chunk;
-                }
+                StartChunkLoad(id);
             }
-            else
-                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+            // Retried once the cancelled loads finish, which wakes the thread again
+            for (auto& id : deferred)
+                m_loadScheduler.Push(id);
         }
     }
 }
\ No newline at end of file
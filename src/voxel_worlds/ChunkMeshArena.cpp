@@ -0,0 +1,83 @@
+#include <wv/voxel_worlds/ChunkMeshArena.h>
+#include <algorithm>
+
+namespace WillowVox
+{
+    ChunkMeshArena::ChunkMeshArena(uint32_t capacity)
+    {
+        Grow(capacity);
+    }
+
+    bool ChunkMeshArena::Allocate(uint32_t size, uint32_t& outOffset)
+    {
+        if (size == 0)
+            return false;
+
+        for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); it++)
+        {
+            if (it->second < size)
+                continue;
+
+            outOffset = it->first;
+            uint32_t remaining = it->second - size;
+            m_freeRanges.erase(it);
+            if (remaining > 0)
+                m_freeRanges.emplace(outOffset + size, remaining);
+
+            m_used += size;
+            return true;
+        }
+
+        return false;
+    }
+
+    void ChunkMeshArena::Free(uint32_t offset, uint32_t size)
+    {
+        if (size == 0)
+            return;
+
+        m_used -= size;
+        InsertFreeRange(offset, size);
+    }
+
+    void ChunkMeshArena::Grow(uint32_t capacity)
+    {
+        if (capacity <= m_capacity)
+            return;
+
+        InsertFreeRange(m_capacity, capacity - m_capacity);
+        m_capacity = capacity;
+    }
+
+    void ChunkMeshArena::InsertFreeRange(uint32_t offset, uint32_t size)
+    {
+        // Merge with the free range after this one
+        auto next = m_freeRanges.lower_bound(offset);
+        if (next != m_freeRanges.end() && offset + size == next->first)
+        {
+            size += next->second;
+            next = m_freeRanges.erase(next);
+        }
+
+        // Merge with the free range before this one
+        if (next != m_freeRanges.begin())
+        {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset)
+            {
+                prev->second += size;
+                return;
+            }
+        }
+
+        m_freeRanges.emplace_hint(next, offset, size);
+    }
+
+    uint32_t ChunkMeshArena::GetLargestFreeRange() const
+    {
+        uint32_t largest = 0;
+        for (auto& [offset, size] : m_freeRanges)
+            largest = std::max(largest, size);
+        return largest;
+    }
+}
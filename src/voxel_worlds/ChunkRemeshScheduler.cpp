@@ -0,0 +1,29 @@
+#include <wv/voxel_worlds/ChunkRemeshScheduler.h>
+
+namespace WillowVox
+{
+    void ChunkRemeshScheduler::Request(const glm::ivec3& id, bool urgent)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto [it, inserted] = m_requests.try_emplace(id, urgent);
+        if (!inserted)
+            it->second = it->second || urgent;
+    }
+
+    void ChunkRemeshScheduler::Take(std::vector<glm::ivec3>& outUrgent, std::vector<glm::ivec3>& outBackground)
+    {
+        std::unordered_map<glm::ivec3, bool> requests;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            requests.swap(m_requests);
+        }
+
+        for (auto& [id, urgent] : requests)
+        {
+            if (urgent)
+                outUrgent.push_back(id);
+            else
+                outBackground.push_back(id);
+        }
+    }
+}
@@ -1,7 +1,19 @@
 #include <wv/voxel_worlds/ChunkRenderer.h>
 #include <wv/voxel_worlds/BlockRegistry.h>
+#include <bit>
 #include <chrono>
 
+// Chunk meshes share one index buffer across vaos, which WVCore's VertexArrayObject can't express
+#if __has_include(<glad/glad.h>)
+#include <glad/glad.h>
+#else
+#include <glad/gl.h>
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
 namespace WillowVox
 {
 #ifdef DEBUG_MODE
@@ -9,6 +21,130 @@ namespace WillowVox
     int ChunkRenderer::m_meshesGenerated = 0;
 #endif
 
+    std::atomic<ChunkRenderer::MeshingMode> ChunkRenderer::s_meshingMode = ChunkRenderer::MeshingMode::Simple;
+    std::atomic<bool> ChunkRenderer::s_caveCulling = false;
+
+    enum Face
+    {
+        FACE_SOUTH, // +Z
+        FACE_NORTH, // -Z
+        FACE_EAST,  // +X
+        FACE_WEST,  // -X
+        FACE_UP,    // +Y
+        FACE_DOWN,  // -Y
+        FACE_COUNT
+    };
+
+    // Chunk blocks and light plus a one block border copied from the neighboring chunks
+    // Uses the same y-major layout as ChunkData::Index
+    struct ChunkRenderer::PaddedChunkVolume
+    {
+        static constexpr int SIZE = CHUNK_SIZE + 2;
+        static constexpr int VOLUME = SIZE * SIZE * SIZE;
+
+        static constexpr int Index(int x, int y, int z) noexcept
+        {
+            return (y + 1) + SIZE * ((x + 1) + SIZE * (z + 1));
+        }
+
+        // Index offset to the neighboring voxel in each face direction
+        static constexpr int FACE_OFFSETS[FACE_COUNT] = { SIZE * SIZE, -SIZE * SIZE, SIZE, -SIZE, 1, -1 };
+
+        BlockId blocks[VOLUME];
+        uint8_t light[VOLUME];
+
+        // Solid bitmask for every padded Y column. Index [z + 1][x + 1], bit y + 1.
+        uint64_t columns[SIZE][SIZE];
+        // Visible faces of every interior column. Index [face][z][x], bit y.
+        uint32_t faceMasks[FACE_COUNT][CHUNK_SIZE][CHUNK_SIZE];
+    };
+
+    // Per-thread pool of mesh buffers
+    // A mesh is built in a pooled buffer and swapped into the chunk, and the chunk's previous buffer
+    // goes back to the pool, so meshing stops allocating once the pools have warmed up.
+    template<typename T>
+    class MeshBufferPool
+    {
+    public:
+        static constexpr size_t MAX_POOLED_BUFFERS = 8;
+
+        // Take the smallest pooled buffer that fits the expected size, or grow the largest one
+        std::vector<T> Acquire(size_t expectedSize)
+        {
+            std::vector<T> buffer;
+            if (!m_buffers.empty())
+            {
+                size_t best = 0;
+                for (size_t i = 1; i < m_buffers.size(); i++)
+                {
+                    size_t capacity = m_buffers[i].capacity();
+                    size_t bestCapacity = m_buffers[best].capacity();
+                    bool fits = capacity >= expectedSize;
+                    bool bestFits = bestCapacity >= expectedSize;
+                    if (fits ? (!bestFits || capacity < bestCapacity) : (!bestFits && capacity > bestCapacity))
+                        best = i;
+                }
+
+                buffer = std::move(m_buffers[best]);
+                m_buffers[best] = std::move(m_buffers.back());
+                m_buffers.pop_back();
+            }
+
+            buffer.clear();
+            buffer.reserve(expectedSize);
+            return buffer;
+        }
+
+        void Release(std::vector<T>&& buffer)
+        {
+            if (buffer.capacity() > 0 && m_buffers.size() < MAX_POOLED_BUFFERS)
+                m_buffers.push_back(std::move(buffer));
+        }
+
+    private:
+        std::vector<std::vector<T>> m_buffers;
+    };
+
+    static thread_local MeshBufferPool<ChunkRenderer::ChunkVertex> s_vertexPool;
+
+    uint32_t ChunkRenderer::GetQuadIndexBuffer(size_t quadCount)
+    {
+        // Lives as long as the GL context
+        static GLuint s_indexBuffer = 0;
+        static size_t s_quadCount = 0;
+
+        if (!s_indexBuffer)
+            glGenBuffers(1, &s_indexBuffer);
+
+        if (quadCount > s_quadCount)
+        {
+            // Doubled so a chunk growing by a few quads doesn't re-upload every time
+            s_quadCount = std::max(quadCount, s_quadCount * 2);
+            std::vector<uint32_t> indices;
+            indices.reserve(s_quadCount * 6);
+            for (uint32_t vertex = 0; vertex < s_quadCount * 4; vertex += 4)
+                indices.insert(indices.end(), { vertex + 0, vertex + 2, vertex + 1, vertex + 1, vertex + 2, vertex + 3 });
+
+            // Uploaded through the copy target, binding the element target would change the bound vao
+            glBindBuffer(GL_COPY_WRITE_BUFFER, s_indexBuffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(indices.size() * sizeof(uint32_t)), indices.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+
+        return s_indexBuffer;
+    }
+
+    // Corner of the quad bounds used by each face vertex: bit 0 = max X, bit 1 = max Y, bit 2 = max Z
+    // Matches the vertex order (and therefore winding) of the simple mesher
+    static constexpr uint8_t FACE_CORNERS[FACE_COUNT][4] = {
+        { 0b100, 0b101, 0b110, 0b111 }, // South
+        { 0b001, 0b000, 0b011, 0b010 }, // North
+        { 0b101, 0b001, 0b111, 0b011 }, // East
+        { 0b000, 0b100, 0b010, 0b110 }, // West
+        { 0b110, 0b111, 0b010, 0b011 }, // Up
+        { 0b101, 0b100, 0b001, 0b000 }  // Down
+    };
+
     ChunkRenderer::ChunkRenderer(std::shared_ptr<ChunkData> chunkData, const glm::ivec3& chunkId)
         : m_chunkData(chunkData), m_chunkId(chunkId), m_chunkPos(chunkId* CHUNK_SIZE)
     {
@@ -19,47 +155,96 @@ namespace WillowVox
     ChunkRenderer::~ChunkRenderer()
     {
         //Logger::Log("Destroying ChunkRenderer at (%d, %d, %d)", m_chunkId.x, m_chunkId.y, m_chunkId.z);
+        if (m_vao)
+        {
+            glDeleteBuffers(1, &m_vertexBuffer);
+            glDeleteVertexArrays(1, &m_vao);
+        }
     }
 
     void ChunkRenderer::Render()
     {
-        // Create vao if it doesn't exist
-        if (!m_vao)
+        // Buffer data is dirty. The mesh is copied out first so a mesh job finishing the next
+        // version isn't blocked on the lock while the driver takes the upload.
+        static std::vector<ChunkVertex> s_uploadVertices;
+        if (CopyMeshIfDirty(s_uploadVertices))
         {
-            m_vao = std::make_unique<VertexArrayObject>();
-            m_vao->SetAttribPointer(0, 3, VertexBufferAttribType::FLOAT32, false, sizeof(ChunkVertex), offsetof(ChunkVertex, pos));
-            m_vao->SetAttribPointer(1, 3, VertexBufferAttribType::FLOAT32, false, sizeof(ChunkVertex), offsetof(ChunkVertex, normal));
-            m_vao->SetAttribPointer(2, 2, VertexBufferAttribType::FLOAT32, false, sizeof(ChunkVertex), offsetof(ChunkVertex, texPos));
-            m_vao->SetAttribPointer(3, 1, VertexBufferAttribType::INT32, false, sizeof(ChunkVertex), offsetof(ChunkVertex, lightLevel));
-            m_vao->SetAttribPointer(4, 1, VertexBufferAttribType::INT32, false, sizeof(ChunkVertex), offsetof(ChunkVertex, skylightLevel));
-        }
+            // Create vao if it doesn't exist, empty chunks never need one
+            if (!m_vao && !s_uploadVertices.empty())
+            {
+                glGenVertexArrays(1, &m_vao);
+                glGenBuffers(1, &m_vertexBuffer);
+                glBindVertexArray(m_vao);
+                glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+                glEnableVertexAttribArray(0);
+                glVertexAttribIPointer(0, 2, GL_INT, sizeof(ChunkVertex), (const void*)offsetof(ChunkVertex, data0));
+                glBindVertexArray(0);
+            }
 
-        // Buffer data is dirty
-        if (m_dirty)
-        {
-            std::lock_guard<std::mutex> lock(m_meshDataMutex);
-            m_vao->BufferVertexData(m_vertices.size() * sizeof(ChunkVertex), m_vertices.data());
-            m_vao->BufferElementData(ElementBufferAttribType::UINT32, m_indices.size(), m_indices.data());
-            m_dirty = false;
+            if (m_vao)
+            {
+                glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+                glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(s_uploadVertices.size() * sizeof(ChunkVertex)), s_uploadVertices.data(), GL_DYNAMIC_DRAW);
+            }
+            m_uploadedQuadCount = s_uploadVertices.size() / 4;
         }
 
+        if (m_uploadedQuadCount == 0)
+            return;
+
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, m_chunkPos);
         m_chunkShader->SetMat4("model", model);
 
-        m_vao->Draw();
+        // Indices only depend on the quad count, so every chunk draws from the shared buffer
+        GLuint indexBuffer = GetQuadIndexBuffer(m_uploadedQuadCount);
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        glDrawElements(GL_TRIANGLES, (GLsizei)(m_uploadedQuadCount * 6), GL_UNSIGNED_INT, nullptr);
+        glBindVertexArray(0);
+    }
+
+    bool ChunkRenderer::CopyMeshIfDirty(std::vector<ChunkVertex>& vertices)
+    {
+        if (!m_dirty)
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_meshDataMutex);
+        vertices.assign(m_vertices.begin(), m_vertices.end());
+        m_dirty = false;
+        return true;
+    }
+
+    // Emit one quad covering the blocks in [lo, hi) on the given face
+    inline void AddQuad(std::vector<ChunkRenderer::ChunkVertex>& vertices, int face,
+        const glm::ivec3& lo, const glm::ivec3& hi, int texIndex, uint32_t atlasBits, uint8_t packedLight)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            uint8_t corner = FACE_CORNERS[face][c];
+            vertices.push_back(ChunkRenderer::ChunkVertex::Pack(
+                corner & 1 ? hi.x : lo.x, corner & 2 ? hi.y : lo.y, corner & 4 ? hi.z : lo.z,
+                face, c, packedLight, texIndex, atlasBits));
+        }
     }
 
-    inline void AddIndices(std::vector<int>& indices, int& vertexCount)
+    inline uint32_t GetAtlasBits(const BlockRegistry& blockRegistry)
     {
-        indices.push_back(vertexCount + 0);
-        indices.push_back(vertexCount + 2);
-        indices.push_back(vertexCount + 1);
-
-        indices.push_back(vertexCount + 1);
-        indices.push_back(vertexCount + 2);
-        indices.push_back(vertexCount + 3);
-        vertexCount += 4;
+        return (uint32_t)std::countr_zero((uint32_t)blockRegistry.GetAtlasWidth()) |
+            (uint32_t)std::countr_zero((uint32_t)blockRegistry.GetAtlasHeight()) << 4;
+    }
+
+    // Scale the positions of a mesh built in downsampled cells back up to blocks
+    static void ScaleVertexPositions(std::vector<ChunkRenderer::ChunkVertex>& vertices, int scale)
+    {
+        constexpr uint32_t POSITION_BITS = (1u << 18) - 1;
+        for (auto& vertex : vertices)
+        {
+            uint32_t x = (vertex.data0 & 0x3F) * scale;
+            uint32_t y = (vertex.data0 >> 6 & 0x3F) * scale;
+            uint32_t z = (vertex.data0 >> 12 & 0x3F) * scale;
+            vertex.data0 = (vertex.data0 & ~POSITION_BITS) | x | y << 6 | z << 12;
+        }
     }
 
     void ChunkRenderer::GenerateMesh(uint32_t currentVersion, bool batch)
@@ -73,317 +258,623 @@ namespace WillowVox
         auto start = std::chrono::high_resolution_clock::now();
         #endif
 
-        std::vector<ChunkVertex> vertices;
-        std::vector<int> indices;
-        int vertexCount = 0;
+        uint16_t lodState = m_lod;
+        int lod = lodState & 0xFF;
+        uint8_t seamFaces = (uint8_t)(lodState >> 8);
+
+        // Snapshot the chunk and its neighbors' borders so meshing never leaves this volume
+        static thread_local auto volume = std::make_unique<PaddedChunkVolume>();
+        if (lod == 0)
+            FillPaddedVolume(*volume, seamFaces);
+        else
+            FillDownsampledVolume(*volume, lod, seamFaces);
+
+        // Reserve from the previous mesh of this chunk, which is usually close to the new one
+        std::vector<ChunkVertex> vertices = s_vertexPool.Acquire(m_lastVertexCount);
+
+        // Chunks without any exposed faces (all air or buried) skip the mesher entirely
+        bool generated = true;
+        bool hasFaces = BuildFaceMasks(*volume);
+        if (lod > 0)
+            hasFaces = ClipFaceMasks(*volume, CHUNK_SIZE >> lod);
+        if (hasFaces)
+        {
+            generated = s_meshingMode == MeshingMode::Greedy
+                ? GenerateGreedyMesh(*volume, vertices, currentVersion)
+                : GenerateSimpleMesh(*volume, vertices, currentVersion);
+        }
+        if (!generated)
+        {
+            s_vertexPool.Release(std::move(vertices));
+            return; // Abort mesh generation if version has changed
+        }
 
-        auto& blockRegistry = BlockRegistry::GetInstance();
+        m_lastVertexCount = vertices.size();
+
+        // Downsampled meshes are built in cells, scale them back up to blocks
+        if (lod > 0)
+            ScaleVertexPositions(vertices, 1 << lod);
+
+        // The visibility graph is only built at full resolution, other levels are treated as open
+        if (s_caveCulling)
+            m_faceConnectivity = lod == 0 ? BuildFaceConnectivity(*volume) : ALL_FACES_CONNECTED;
+
+        // Hand the finished buffer to the chunk and keep its old one for the next mesh
+        {
+            std::lock_guard<std::mutex> lock(m_meshDataMutex);
+            std::swap(m_vertices, vertices);
+        }
+        s_vertexPool.Release(std::move(vertices));
+
+        if (!batch)
+            m_dirty = true;
+
+        #ifdef DEBUG_MODE
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        m_meshesGenerated++;
+        m_avgMeshGenTime = m_avgMeshGenTime + (duration.count() - m_avgMeshGenTime) / std::min(m_meshesGenerated, 1);
+        #endif
+    }
 
+    void ChunkRenderer::FillPaddedVolume(PaddedChunkVolume& volume, uint8_t seamFaces) const
+    {
+        // Interior
         for (int z = 0; z < CHUNK_SIZE; z++)
         {
             for (int x = 0; x < CHUNK_SIZE; x++)
             {
-                if (currentVersion != m_version)
-                    return; // Abort mesh generation if version has changed
-
+                int index = PaddedChunkVolume::Index(x, 0, z);
                 for (int y = 0; y < CHUNK_SIZE; y++)
                 {
-                    BlockId id = m_chunkData->Get(x, y, z);
-                    if (id == 0)
+                    volume.blocks[index + y] = m_chunkData->Get(x, y, z);
+                    volume.light[index + y] = m_chunkData->GetPackedLight(x, y, z);
+                }
+            }
+        }
+
+        // Border slices. Missing neighbors are air with no light, so faces facing them are kept.
+        // Neighbors across a LOD seam keep their light but count as air for the same reason.
+        auto copySlice = [&](int face, const std::shared_ptr<ChunkData>& neighbor, auto toNeighbor, auto toPadded) {
+            bool seam = seamFaces >> face & 1;
+            for (int a = 0; a < CHUNK_SIZE; a++)
+            {
+                for (int b = 0; b < CHUNK_SIZE; b++)
+                {
+                    int index = toPadded(a, b);
+                    if (neighbor)
+                    {
+                        glm::ivec3 pos = toNeighbor(a, b);
+                        volume.blocks[index] = seam ? 0 : neighbor->Get(pos.x, pos.y, pos.z);
+                        volume.light[index] = neighbor->GetPackedLight(pos.x, pos.y, pos.z);
+                    }
+                    else
+                    {
+                        volume.blocks[index] = 0;
+                        volume.light[index] = 0;
+                    }
+                }
+            }
+        };
+
+        copySlice(FACE_SOUTH, m_southChunkData,
+            [](int x, int y) { return glm::ivec3(x, y, 0); },
+            [](int x, int y) { return PaddedChunkVolume::Index(x, y, CHUNK_SIZE); });
+        copySlice(FACE_NORTH, m_northChunkData,
+            [](int x, int y) { return glm::ivec3(x, y, CHUNK_SIZE - 1); },
+            [](int x, int y) { return PaddedChunkVolume::Index(x, y, -1); });
+        copySlice(FACE_EAST, m_eastChunkData,
+            [](int z, int y) { return glm::ivec3(0, y, z); },
+            [](int z, int y) { return PaddedChunkVolume::Index(CHUNK_SIZE, y, z); });
+        copySlice(FACE_WEST, m_westChunkData,
+            [](int z, int y) { return glm::ivec3(CHUNK_SIZE - 1, y, z); },
+            [](int z, int y) { return PaddedChunkVolume::Index(-1, y, z); });
+        copySlice(FACE_UP, m_upChunkData,
+            [](int x, int z) { return glm::ivec3(x, 0, z); },
+            [](int x, int z) { return PaddedChunkVolume::Index(x, CHUNK_SIZE, z); });
+        copySlice(FACE_DOWN, m_downChunkData,
+            [](int x, int z) { return glm::ivec3(x, CHUNK_SIZE - 1, z); },
+            [](int x, int z) { return PaddedChunkVolume::Index(x, -1, z); });
+    }
+
+    // Sample a cell of scale^3 blocks starting at the given block
+    // The cell is solid when at least half of it is, using its most common block, and takes the
+    // brightest light of each kind in it so downsampled terrain isn't darker than the full mesh.
+    static void SampleCell(const ChunkData& chunkData, const glm::ivec3& origin, int scale, BlockId& outBlock, uint8_t& outLight)
+    {
+        constexpr int MAX_CANDIDATES = 8;
+        BlockId candidates[MAX_CANDIDATES];
+        int counts[MAX_CANDIDATES];
+        int candidateCount = 0;
+        int solid = 0;
+        uint8_t lightLow = 0;
+        uint8_t lightHigh = 0;
+
+        for (int z = origin.z; z < origin.z + scale; z++)
+        {
+            for (int x = origin.x; x < origin.x + scale; x++)
+            {
+                for (int y = origin.y; y < origin.y + scale; y++)
+                {
+                    uint8_t light = chunkData.GetPackedLight(x, y, z);
+                    lightLow = std::max<uint8_t>(lightLow, light & 0x0F);
+                    lightHigh = std::max<uint8_t>(lightHigh, light & 0xF0);
+
+                    BlockId block = chunkData.Get(x, y, z);
+                    if (block == 0)
                         continue;
 
-                    auto& block = blockRegistry.GetBlock(id);
+                    solid++;
+                    int i = 0;
+                    while (i < candidateCount && candidates[i] != block)
+                        i++;
+                    if (i < candidateCount)
+                        counts[i]++;
+                    else if (candidateCount < MAX_CANDIDATES)
+                    {
+                        candidates[candidateCount] = block;
+                        counts[candidateCount++] = 1;
+                    }
+                }
+            }
+        }
+
+        outBlock = 0;
+        if (solid * 2 >= scale * scale * scale)
+        {
+            int best = 0;
+            for (int i = 1; i < candidateCount; i++)
+            {
+                if (counts[i] > counts[best])
+                    best = i;
+            }
+            outBlock = candidates[best];
+        }
+        outLight = lightLow | lightHigh;
+    }
+
+    void ChunkRenderer::FillDownsampledVolume(PaddedChunkVolume& volume, int level, uint8_t seamFaces) const
+    {
+        const int scale = 1 << level;
+        const int size = CHUNK_SIZE >> level;
+
+        // Everything outside the sampled cells is air, so the unused part of the volume has no faces
+        std::fill(std::begin(volume.blocks), std::end(volume.blocks), 0);
+        std::fill(std::begin(volume.light), std::end(volume.light), 0);
+
+        // Interior cells
+        for (int z = 0; z < size; z++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                for (int y = 0; y < size; y++)
+                {
+                    int index = PaddedChunkVolume::Index(x, y, z);
+                    SampleCell(*m_chunkData, glm::ivec3(x, y, z) * scale, scale, volume.blocks[index], volume.light[index]);
+                }
+            }
+        }
+
+        // Border cells sampled from the neighbors' adjacent cell layer, at padded index -1 or size.
+        // Missing neighbors stay air with no light, and neighbors across a LOD seam keep their light
+        // but count as air, so faces facing either are kept.
+        auto sampleSlice = [&](int face, const std::shared_ptr<ChunkData>& neighbor, auto toNeighborCell, auto toPadded) {
+            if (!neighbor)
+                return;
+
+            bool seam = seamFaces >> face & 1;
+            for (int a = 0; a < size; a++)
+            {
+                for (int b = 0; b < size; b++)
+                {
+                    int index = toPadded(a, b);
+                    SampleCell(*neighbor, toNeighborCell(a, b) * scale, scale, volume.blocks[index], volume.light[index]);
+                    if (seam)
+                        volume.blocks[index] = 0;
+                }
+            }
+        };
+
+        sampleSlice(FACE_SOUTH, m_southChunkData,
+            [](int x, int y) { return glm::ivec3(x, y, 0); },
+            [size](int x, int y) { return PaddedChunkVolume::Index(x, y, size); });
+        sampleSlice(FACE_NORTH, m_northChunkData,
+            [size](int x, int y) { return glm::ivec3(x, y, size - 1); },
+            [](int x, int y) { return PaddedChunkVolume::Index(x, y, -1); });
+        sampleSlice(FACE_EAST, m_eastChunkData,
+            [](int z, int y) { return glm::ivec3(0, y, z); },
+            [size](int z, int y) { return PaddedChunkVolume::Index(size, y, z); });
+        sampleSlice(FACE_WEST, m_westChunkData,
+            [size](int z, int y) { return glm::ivec3(size - 1, y, z); },
+            [](int z, int y) { return PaddedChunkVolume::Index(-1, y, z); });
+        sampleSlice(FACE_UP, m_upChunkData,
+            [](int x, int z) { return glm::ivec3(x, 0, z); },
+            [size](int x, int z) { return PaddedChunkVolume::Index(x, size, z); });
+        sampleSlice(FACE_DOWN, m_downChunkData,
+            [size](int x, int z) { return glm::ivec3(x, size - 1, z); },
+            [](int x, int z) { return PaddedChunkVolume::Index(x, -1, z); });
+    }
+
+    // Pack a run of padded column voxels into a solid bitmask, starting at bit 0
+    static inline uint64_t BuildSolidMask(const BlockId* column, int count)
+    {
+        uint64_t mask = 0;
+        int y = 0;
+
+        static_assert(sizeof(BlockId) == 4, "solid mask SIMD assumes 32-bit block ids");
+#if defined(__AVX2__)
+        const __m256i zero = _mm256_setzero_si256();
+        for (; y + 8 <= count; y += 8)
+        {
+            __m256i air = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(column + y)), zero);
+            mask |= (uint64_t)(~_mm256_movemask_ps(_mm256_castsi256_ps(air)) & 0xFF) << y;
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128i zero = _mm_setzero_si128();
+        for (; y + 4 <= count; y += 4)
+        {
+            __m128i air = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(column + y)), zero);
+            mask |= (uint64_t)(~_mm_movemask_ps(_mm_castsi128_ps(air)) & 0xF) << y;
+        }
+#endif
+        for (; y < count; y++)
+            mask |= (uint64_t)(column[y] != 0) << y;
+
+        return mask;
+    }
+
+    bool ChunkRenderer::BuildFaceMasks(PaddedChunkVolume& volume) const
+    {
+        constexpr int PADDED_SIZE = PaddedChunkVolume::SIZE;
+        constexpr uint64_t INNER_BITS = ((1ull << CHUNK_SIZE) - 1) << 1;
+
+        for (int pz = 0; pz < PADDED_SIZE; pz++)
+        {
+            for (int px = 0; px < PADDED_SIZE; px++)
+                volume.columns[pz][px] = BuildSolidMask(&volume.blocks[PaddedChunkVolume::Index(px - 1, -1, pz - 1)], PADDED_SIZE);
+        }
+
+        // A face is visible where the column is solid and the neighbor in that direction is not.
+        // Each row of 32 columns is processed several columns at a time.
+        uint64_t anyFaces = 0;
+        for (int z = 0; z < CHUNK_SIZE; z++)
+        {
+            const uint64_t* center = &volume.columns[z + 1][1];
+            const uint64_t* south = &volume.columns[z + 2][1];
+            const uint64_t* north = &volume.columns[z][1];
+            const uint64_t* east = &volume.columns[z + 1][2];
+            const uint64_t* west = &volume.columns[z + 1][0];
+
+            int x = 0;
+#if defined(__AVX2__)
+            const __m256i inner = _mm256_set1_epi64x((long long)INNER_BITS);
+            const __m256i lowWords = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+            __m256i anyVec = _mm256_setzero_si256();
+            for (; x + 4 <= CHUNK_SIZE; x += 4)
+            {
+                __m256i c = _mm256_loadu_si256((const __m256i*)(center + x));
+                __m256i masks[FACE_COUNT] = {
+                    _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*)(south + x)), c),
+                    _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*)(north + x)), c),
+                    _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*)(east + x)), c),
+                    _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*)(west + x)), c),
+                    _mm256_andnot_si256(_mm256_srli_epi64(c, 1), c),
+                    _mm256_andnot_si256(_mm256_slli_epi64(c, 1), c)
+                };
+                for (int face = 0; face < FACE_COUNT; face++)
+                {
+                    // Drop the padding bits and narrow each 64-bit lane to 32 bits
+                    __m256i m = _mm256_srli_epi64(_mm256_and_si256(masks[face], inner), 1);
+                    anyVec = _mm256_or_si256(anyVec, m);
+                    m = _mm256_permutevar8x32_epi32(m, lowWords);
+                    _mm_storeu_si128((__m128i*)&volume.faceMasks[face][z][x], _mm256_castsi256_si128(m));
+                }
+            }
+            anyFaces |= (uint64_t)!_mm256_testz_si256(anyVec, anyVec);
+#elif defined(__SSE2__) || defined(_M_X64)
+            const __m128i inner = _mm_set1_epi64x((long long)INNER_BITS);
+            __m128i anyVec = _mm_setzero_si128();
+            for (; x + 2 <= CHUNK_SIZE; x += 2)
+            {
+                __m128i c = _mm_loadu_si128((const __m128i*)(center + x));
+                __m128i masks[FACE_COUNT] = {
+                    _mm_andnot_si128(_mm_loadu_si128((const __m128i*)(south + x)), c),
+                    _mm_andnot_si128(_mm_loadu_si128((const __m128i*)(north + x)), c),
+                    _mm_andnot_si128(_mm_loadu_si128((const __m128i*)(east + x)), c),
+                    _mm_andnot_si128(_mm_loadu_si128((const __m128i*)(west + x)), c),
+                    _mm_andnot_si128(_mm_srli_epi64(c, 1), c),
+                    _mm_andnot_si128(_mm_slli_epi64(c, 1), c)
+                };
+                for (int face = 0; face < FACE_COUNT; face++)
+                {
+                    // Drop the padding bits and narrow each 64-bit lane to 32 bits
+                    __m128i m = _mm_srli_epi64(_mm_and_si128(masks[face], inner), 1);
+                    anyVec = _mm_or_si128(anyVec, m);
+                    m = _mm_shuffle_epi32(m, _MM_SHUFFLE(3, 1, 2, 0));
+                    _mm_storel_epi64((__m128i*)&volume.faceMasks[face][z][x], m);
+                }
+            }
+            anyFaces |= (uint64_t)(_mm_movemask_epi8(_mm_cmpeq_epi32(anyVec, _mm_setzero_si128())) != 0xFFFF);
+#endif
+            for (; x < CHUNK_SIZE; x++)
+            {
+                uint64_t c = center[x];
+                uint64_t masks[FACE_COUNT] = {
+                    c & ~south[x], c & ~north[x], c & ~east[x], c & ~west[x], c & ~(c >> 1), c & ~(c << 1)
+                };
+                for (int face = 0; face < FACE_COUNT; face++)
+                {
+                    uint32_t m = (uint32_t)((masks[face] & INNER_BITS) >> 1);
+                    volume.faceMasks[face][z][x] = m;
+                    anyFaces |= m;
+                }
+            }
+        }
+
+        return anyFaces != 0;
+    }
+
+    bool ChunkRenderer::ClipFaceMasks(PaddedChunkVolume& volume, int size)
+    {
+        // The border cells at index size are only there to cull against, they get no faces of their own
+        uint32_t rowBits = (uint32_t)((1ull << size) - 1);
+        uint32_t anyFaces = 0;
+        for (int face = 0; face < FACE_COUNT; face++)
+        {
+            for (int z = 0; z < CHUNK_SIZE; z++)
+            {
+                for (int x = 0; x < CHUNK_SIZE; x++)
+                {
+                    uint32_t& mask = volume.faceMasks[face][z][x];
+                    mask = x < size && z < size ? mask & rowBits : 0;
+                    anyFaces |= mask;
+                }
+            }
+        }
+
+        return anyFaces != 0;
+    }
+
+    uint64_t ChunkRenderer::BuildFaceConnectivity(const PaddedChunkVolume& volume)
+    {
+        constexpr uint32_t TOP_BIT = 1u << (CHUNK_SIZE - 1);
+
+        // Open voxels of every interior column, bit y
+        uint32_t open[CHUNK_SIZE][CHUNK_SIZE];
+        uint32_t anyOpen = 0, allOpen = ~0u;
+        for (int z = 0; z < CHUNK_SIZE; z++)
+        {
+            for (int x = 0; x < CHUNK_SIZE; x++)
+            {
+                open[z][x] = ~(uint32_t)(volume.columns[z + 1][x + 1] >> 1);
+                anyOpen |= open[z][x];
+                allOpen &= open[z][x];
+            }
+        }
+
+        if (anyOpen == 0)
+            return 0;
+        if (allOpen == ~0u)
+            return ALL_FACES_CONNECTED;
+
+        // Flood fill each open region a column run at a time and connect every face it touches
+        struct Span
+        {
+            int z, x;
+            uint32_t bits;
+        };
+        static thread_local std::vector<Span> stack;
+        uint32_t visited[CHUNK_SIZE][CHUNK_SIZE] = {};
+        uint64_t connectivity = 0;
 
-                    // South Face
+        for (int z = 0; z < CHUNK_SIZE; z++)
+        {
+            for (int x = 0; x < CHUNK_SIZE; x++)
+            {
+                while (uint32_t remaining = open[z][x] & ~visited[z][x])
+                {
+                    uint32_t faces = 0;
+                    stack.push_back({ z, x, 1u << std::countr_zero(remaining) });
+                    while (!stack.empty())
                     {
-                        bool south;
-                        if (z + 1 >= CHUNK_SIZE)
-                        {
-                            if (m_southChunkData)
-                                south = m_southChunkData->Get(x, y, 0) == 0;
-                            else
-                                south = true;
-                        }
-                        else
-                            south = m_chunkData->Get(x, y, z + 1) == 0;
-                        if (south)
-                        {
-                            int lightLevel;
-                            if (z + 1 >= CHUNK_SIZE)
-                            {
-                                if (m_southChunkData)
-                                    lightLevel = m_southChunkData->GetLightLevel(x, y, 0);
-                                else
-                                    lightLevel = 0;
-                            }
-                            else
-                                lightLevel = m_chunkData->GetLightLevel(x, y, z + 1);
-
-                            int skyLightLevel;
-                            if (z + 1 >= CHUNK_SIZE)
-                            {
-                                if (m_southChunkData)
-                                    skyLightLevel = m_southChunkData->GetSkyLightLevel(x, y, 0);
-                                else
-                                    skyLightLevel = 0;
-                            }
-                            else
-                                skyLightLevel = m_chunkData->GetSkyLightLevel(x, y, z + 1);
-
-                            // South Face
-                            vertices.push_back({ { x + 0, y + 0, z + 1 }, { 0, 0, 1 }, { block.sideTexMinX, block.sideTexMinY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 1, y + 0, z + 1 }, { 0, 0, 1 }, { block.sideTexMaxX, block.sideTexMinY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 0, y + 1, z + 1 }, { 0, 0, 1 }, { block.sideTexMinX, block.sideTexMaxY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 1, y + 1, z + 1 }, { 0, 0, 1 }, { block.sideTexMaxX, block.sideTexMaxY }, lightLevel, skyLightLevel });
-
-                            AddIndices(indices, vertexCount);
-                        }
+                        Span span = stack.back();
+                        stack.pop_back();
+
+                        uint32_t columnOpen = open[span.z][span.x] & ~visited[span.z][span.x];
+                        uint32_t bits = span.bits & columnOpen;
+                        if (bits == 0)
+                            continue;
+
+                        // Grow the seed bits to the open runs containing them
+                        for (uint32_t grown; (grown = (bits | bits << 1 | bits >> 1) & columnOpen) != bits;)
+                            bits = grown;
+                        visited[span.z][span.x] |= bits;
+
+                        if (bits & 1) faces |= 1 << FACE_DOWN;
+                        if (bits & TOP_BIT) faces |= 1 << FACE_UP;
+                        if (span.x == 0) faces |= 1 << FACE_WEST;
+                        if (span.x == CHUNK_SIZE - 1) faces |= 1 << FACE_EAST;
+                        if (span.z == 0) faces |= 1 << FACE_NORTH;
+                        if (span.z == CHUNK_SIZE - 1) faces |= 1 << FACE_SOUTH;
+
+                        if (span.x > 0) stack.push_back({ span.z, span.x - 1, bits });
+                        if (span.x < CHUNK_SIZE - 1) stack.push_back({ span.z, span.x + 1, bits });
+                        if (span.z > 0) stack.push_back({ span.z - 1, span.x, bits });
+                        if (span.z < CHUNK_SIZE - 1) stack.push_back({ span.z + 1, span.x, bits });
                     }
 
-                    // North Face
+                    for (int face = 0; face < FACE_COUNT; face++)
                     {
-                        bool north;
-                        if (z < 1)
-                        {
-                            if (m_northChunkData)
-                                north = m_northChunkData->Get(x, y, CHUNK_SIZE - 1) == 0;
-                            else
-                                north = true;
-                        }
-                        else
-                            north = m_chunkData->Get(x, y, z - 1) == 0;
-                        if (north)
-                        {
-                            int lightLevel;
-                            if (z < 1)
-                            {
-                                if (m_northChunkData)
-                                    lightLevel = m_northChunkData->GetLightLevel(x, y, CHUNK_SIZE - 1);
-                                else
-                                    lightLevel = 0;
-                            }
-                            else
-                                lightLevel = m_chunkData->GetLightLevel(x, y, z - 1);
-
-                            int skyLightLevel;
-                            if (z < 1)
-                            {
-                                if (m_northChunkData)
-                                    skyLightLevel = m_northChunkData->GetSkyLightLevel(x, y, CHUNK_SIZE - 1);
-                                else
-                                    skyLightLevel = 0;
-                            }
-                            else
-                                skyLightLevel = m_chunkData->GetSkyLightLevel(x, y, z - 1);
-
-                            // North Face
-                            vertices.push_back({ { x + 1, y + 0, z + 0 }, { 0, 0, -1 }, { block.sideTexMinX, block.sideTexMinY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 0, y + 0, z + 0 }, { 0, 0, -1 }, { block.sideTexMaxX, block.sideTexMinY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 1, y + 1, z + 0 }, { 0, 0, -1 }, { block.sideTexMinX, block.sideTexMaxY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 0, y + 1, z + 0 }, { 0, 0, -1 }, { block.sideTexMaxX, block.sideTexMaxY }, lightLevel, skyLightLevel });
-
-                            AddIndices(indices, vertexCount);
-                        }
+                        if (faces >> face & 1)
+                            connectivity |= (uint64_t)faces << (face * FACE_COUNT);
+                    }
+                    if (connectivity == ALL_FACES_CONNECTED)
+                        return connectivity;
+                }
+            }
+        }
+
+        return connectivity;
+    }
+
+    bool ChunkRenderer::GenerateSimpleMesh(const PaddedChunkVolume& volume, std::vector<ChunkVertex>& vertices, uint32_t currentVersion)
+    {
+        auto& blockRegistry = BlockRegistry::GetInstance();
+        uint32_t atlasBits = GetAtlasBits(blockRegistry);
+
+        BlockId cachedId = 0;
+        int texIndices[FACE_COUNT] = {};
+
+        for (int z = 0; z < CHUNK_SIZE; z++)
+        {
+            for (int x = 0; x < CHUNK_SIZE; x++)
+            {
+                if (currentVersion != m_version)
+                    return false; // Abort mesh generation if version has changed
+
+                uint32_t faceMasks[FACE_COUNT];
+                uint32_t exposed = 0;
+                for (int face = 0; face < FACE_COUNT; face++)
+                {
+                    faceMasks[face] = volume.faceMasks[face][z][x];
+                    exposed |= faceMasks[face];
+                }
+
+                // Only visit blocks with at least one visible face
+                for (; exposed; exposed &= exposed - 1)
+                {
+                    int y = std::countr_zero(exposed);
+                    int index = PaddedChunkVolume::Index(x, y, z);
+                    BlockId id = volume.blocks[index];
+
+                    if (id != cachedId)
+                    {
+                        auto& block = blockRegistry.GetBlock(id);
+                        for (int face = 0; face < FACE_COUNT; face++)
+                            texIndices[face] = face == FACE_UP ? block.topTexIndex : face == FACE_DOWN ? block.bottomTexIndex : block.sideTexIndex;
+                        cachedId = id;
                     }
-                    // East Face
+
+                    for (int face = 0; face < FACE_COUNT; face++)
                     {
-                        bool east;
-                        if (x + 1 >= CHUNK_SIZE)
-                        {
-                            if (m_eastChunkData)
-                                east = m_eastChunkData->Get(0, y, z) == 0;
-                            else
-                                east = true;
-                        }
-                        else
-                            east = m_chunkData->Get(x + 1, y, z) == 0;
-                        if (east)
-                        {
-                            int lightLevel;
-                            if (x + 1 >= CHUNK_SIZE)
-                            {
-                                if (m_eastChunkData)
-                                    lightLevel = m_eastChunkData->GetLightLevel(0, y, z);
-                                else
-                                    lightLevel = 0;
-                            }
-                            else
-                                lightLevel = m_chunkData->GetLightLevel(x + 1, y, z);
-
-                            int skyLightLevel;
-                            if (x + 1 >= CHUNK_SIZE)
-                            {
-                                if (m_eastChunkData)
-                                    skyLightLevel = m_eastChunkData->GetSkyLightLevel(0, y, z);
-                                else
-                                    skyLightLevel = 0;
-                            }
-                            else
-                                skyLightLevel = m_chunkData->GetSkyLightLevel(x + 1, y, z);
-
-                            // East Face
-                            vertices.push_back({ { x + 1, y + 0, z + 1 }, { -1, 0, 0 }, { block.sideTexMinX, block.sideTexMinY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 1, y + 0, z + 0 }, { -1, 0, 0 }, { block.sideTexMaxX, block.sideTexMinY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 1, y + 1, z + 1 }, { -1, 0, 0 }, { block.sideTexMinX, block.sideTexMaxY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 1, y + 1, z + 0 }, { -1, 0, 0 }, { block.sideTexMaxX, block.sideTexMaxY }, lightLevel, skyLightLevel });
-
-                            AddIndices(indices, vertexCount);
-                        }
+                        if (!(faceMasks[face] >> y & 1))
+                            continue;
+
+                        int neighbor = index + PaddedChunkVolume::FACE_OFFSETS[face];
+                        AddQuad(vertices, face, { x, y, z }, { x + 1, y + 1, z + 1 }, texIndices[face], atlasBits, volume.light[neighbor]);
                     }
-                    // West Face
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool ChunkRenderer::GenerateGreedyMesh(const PaddedChunkVolume& volume, std::vector<ChunkVertex>& vertices, uint32_t currentVersion)
+    {
+        auto& blockRegistry = BlockRegistry::GetInstance();
+        uint32_t atlasBits = GetAtlasBits(blockRegistry);
+
+        // Each slice is a 32x32 grid of faces. Rows are bitmasks along the u axis, and faces can
+        // only merge when their block id and light values (the key) are identical.
+        uint32_t rows[CHUNK_SIZE];
+        uint64_t keys[CHUNK_SIZE][CHUNK_SIZE];
+
+        for (int face = 0; face < FACE_COUNT; face++)
+        {
+            bool vertical = face == FACE_UP || face == FACE_DOWN;
+            int offset = PaddedChunkVolume::FACE_OFFSETS[face];
+
+            for (int slice = 0; slice < CHUNK_SIZE; slice++)
+            {
+                if (currentVersion != m_version)
+                    return false;
+
+                // Side faces use u = y, v = the horizontal axis in the face plane
+                // Up and down faces use u = x, v = z
+                auto toBlock = [&](int u, int v) -> glm::ivec3 {
+                    if (vertical)
+                        return { u, slice, v };
+                    if (face == FACE_EAST || face == FACE_WEST)
+                        return { slice, u, v };
+                    return { v, u, slice };
+                };
+
+                bool anyFaces = false;
+                for (int v = 0; v < CHUNK_SIZE; v++)
+                {
+                    uint32_t row = 0;
+                    if (vertical)
                     {
-                        bool west;
-                        if (x < 1)
-                        {
-                            if (m_westChunkData)
-                                west = m_westChunkData->Get(CHUNK_SIZE - 1, y, z) == 0;
-                            else
-                                west = true;
-                        }
-                        else
-                            west = m_chunkData->Get(x - 1, y, z) == 0;
-                        if (west)
-                        {
-                            int lightLevel;
-                            if (x < 1)
-                            {
-                                if (m_westChunkData)
-                                    lightLevel = m_westChunkData->GetLightLevel(CHUNK_SIZE - 1, y, z);
-                                else
-                                    lightLevel = 0;
-                            }
-                            else
-                                lightLevel = m_chunkData->GetLightLevel(x - 1, y, z);
-
-                            int skyLightLevel;
-                            if (x < 1)
-                            {
-                                if (m_westChunkData)
-                                    skyLightLevel = m_westChunkData->GetSkyLightLevel(CHUNK_SIZE - 1, y, z);
-                                else
-                                    skyLightLevel = 0;
-                            }
-                            else
-                                skyLightLevel = m_chunkData->GetSkyLightLevel(x - 1, y, z);
-
-                            // West Face
-                            vertices.push_back({ { x + 0, y + 0, z + 0 }, { 1, 0, 0 }, { block.sideTexMinX, block.sideTexMinY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 0, y + 0, z + 1 }, { 1, 0, 0 }, { block.sideTexMaxX, block.sideTexMinY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 0, y + 1, z + 0 }, { 1, 0, 0 }, { block.sideTexMinX, block.sideTexMaxY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 0, y + 1, z + 1 }, { 1, 0, 0 }, { block.sideTexMaxX, block.sideTexMaxY }, lightLevel, skyLightLevel });
-
-                            AddIndices(indices, vertexCount);
-                        }
+                        for (int u = 0; u < CHUNK_SIZE; u++)
+                            row |= (volume.faceMasks[face][v][u] >> slice & 1) << u;
                     }
-                    // Up Face
+                    else if (face == FACE_EAST || face == FACE_WEST)
+                        row = volume.faceMasks[face][v][slice];
+                    else
+                        row = volume.faceMasks[face][slice][v];
+
+                    rows[v] = row;
+                    anyFaces |= row != 0;
+
+                    for (uint32_t bits = row; bits; bits &= bits - 1)
                     {
-                        bool up;
-                        if (y + 1 >= CHUNK_SIZE)
-                        {
-                            if (m_upChunkData)
-                                up = m_upChunkData->Get(x, 0, z) == 0;
-                            else
-                                up = true;
-                        }
-                        else
-                            up = m_chunkData->Get(x, y + 1, z) == 0;
-                        if (up)
-                        {
-                            int lightLevel;
-                            if (y + 1 >= CHUNK_SIZE)
-                            {
-                                if (m_upChunkData)
-                                    lightLevel = m_upChunkData->GetLightLevel(x, 0, z);
-                                else
-                                    lightLevel = 0;
-                            }
-                            else
-                                lightLevel = m_chunkData->GetLightLevel(x, y + 1, z);
-
-                            int skyLightLevel;
-                            if (y + 1 >= CHUNK_SIZE)
-                            {
-                                if (m_upChunkData)
-                                    skyLightLevel = m_upChunkData->GetSkyLightLevel(x, 0, z);
-                                else
-                                    skyLightLevel = 0;
-                            }
-                            else
-                                skyLightLevel = m_chunkData->GetSkyLightLevel(x, y + 1, z);
-
-                            // Up Face
-                            vertices.push_back({ { x + 0, y + 1, z + 1 }, { 0, 1, 0 }, { block.topTexMinX, block.topTexMinY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 1, y + 1, z + 1 }, { 0, 1, 0 }, { block.topTexMaxX, block.topTexMinY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 0, y + 1, z + 0 }, { 0, 1, 0 }, { block.topTexMinX, block.topTexMaxY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 1, y + 1, z + 0 }, { 0, 1, 0 }, { block.topTexMaxX, block.topTexMaxY }, lightLevel, skyLightLevel });
-
-                            AddIndices(indices, vertexCount);
-                        }
+                        int u = std::countr_zero(bits);
+                        glm::ivec3 pos = toBlock(u, v);
+                        int index = PaddedChunkVolume::Index(pos.x, pos.y, pos.z);
+                        keys[v][u] = ((uint64_t)volume.blocks[index] << 8) | volume.light[index + offset];
                     }
-                    // Down Face
+                }
+
+                if (!anyFaces)
+                    continue;
+
+                for (int v = 0; v < CHUNK_SIZE; v++)
+                {
+                    while (rows[v])
                     {
-                        bool down;
-                        if (y < 1)
+                        int u = std::countr_zero(rows[v]);
+                        uint64_t key = keys[v][u];
+
+                        // Extend along u while faces exist and share the key
+                        int width = 1;
+                        while (u + width < CHUNK_SIZE && (rows[v] >> (u + width) & 1) && keys[v][u + width] == key)
+                            width++;
+                        uint32_t runMask = (width == 32 ? ~0u : ((1u << width) - 1)) << u;
+
+                        // Extend along v while the whole run matches
+                        int height = 1;
+                        while (v + height < CHUNK_SIZE && (rows[v + height] & runMask) == runMask)
                         {
-                            if (m_downChunkData)
-                                down = m_downChunkData->Get(x, CHUNK_SIZE - 1, z) == 0;
-                            else
-                                down = true;
+                            bool match = true;
+                            for (int i = u; i < u + width && match; i++)
+                                match = keys[v + height][i] == key;
+                            if (!match)
+                                break;
+                            height++;
                         }
+
+                        for (int i = v; i < v + height; i++)
+                            rows[i] &= ~runMask;
+
+                        // Emit the merged quad
+                        glm::ivec3 lo = toBlock(u, v);
+                        glm::ivec3 hi = toBlock(u + width, v + height);
+                        if (vertical)
+                            hi.y = lo.y + 1;
+                        else if (face == FACE_EAST || face == FACE_WEST)
+                            hi.x = lo.x + 1;
                         else
-                            down = m_chunkData->Get(x, y - 1, z) == 0;
-                        if (down)
-                        {
-                            int lightLevel;
-                            if (y < 1)
-                            {
-                                if (m_downChunkData)
-                                    lightLevel = m_downChunkData->GetLightLevel(x, CHUNK_SIZE - 1, z);
-                                else
-                                    lightLevel = 0;
-                            }
-                            else
-                                lightLevel = m_chunkData->GetLightLevel(x, y - 1, z);
-
-                            int skyLightLevel;                            
-                            if (y < 1)
-                            {
-                                if (m_downChunkData)
-                                    skyLightLevel = m_downChunkData->GetSkyLightLevel(x, CHUNK_SIZE - 1, z);
-                                else
-                                    skyLightLevel = 0;
-                            }
-                            else
-                                skyLightLevel = m_chunkData->GetSkyLightLevel(x, y - 1, z);
-
-                            // Down Face
-                            vertices.push_back({ { x + 1, y + 0, z + 1 }, { 0, -1, 0 }, { block.bottomTexMinX, block.bottomTexMinY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 0, y + 0, z + 1 }, { 0, -1, 0 }, { block.bottomTexMaxX, block.bottomTexMinY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 1, y + 0, z + 0 }, { 0, -1, 0 }, { block.bottomTexMinX, block.bottomTexMaxY }, lightLevel, skyLightLevel });
-                            vertices.push_back({ { x + 0, y + 0, z + 0 }, { 0, -1, 0 }, { block.bottomTexMaxX, block.bottomTexMaxY }, lightLevel, skyLightLevel });
-
-                            AddIndices(indices, vertexCount);
-                        }
+                            hi.z = lo.z + 1;
+
+                        auto& block = blockRegistry.GetBlock((BlockId)(key >> 8));
+                        int texIndex = face == FACE_UP ? block.topTexIndex : face == FACE_DOWN ? block.bottomTexIndex : block.sideTexIndex;
+                        AddQuad(vertices, face, lo, hi, texIndex, atlasBits, (uint8_t)key);
                     }
                 }
             }
         }
 
-
-        {
-            std::lock_guard<std::mutex> lock(m_meshDataMutex);
-            std::swap(m_vertices, vertices);
-            std::swap(m_indices, indices);
-        }
-
-        if (!batch)
-            m_dirty = true;
-
-        #ifdef DEBUG_MODE
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-        m_meshesGenerated++;
-        m_avgMeshGenTime = m_avgMeshGenTime + (duration.count() - m_avgMeshGenTime) / std::min(m_meshesGenerated, 1);
-        #endif
+        return true;
     }
-}
\ No newline at end of file
+}
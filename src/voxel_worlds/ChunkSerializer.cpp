@@ -0,0 +1,267 @@
+#include <wv/voxel_worlds/ChunkSerializer.h>
+#include <wv/voxel_worlds/LZCompression.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+namespace WillowVox
+{
+    namespace ChunkSerializer
+    {
+        // Every voxel in its own run of both blocks and light, with the longest encodings
+        static constexpr uint32_t MAX_BODY_SIZE = CHUNK_VOLUME * 8;
+
+        static void PutU32(uint8_t* out, uint32_t value)
+        {
+            out[0] = (uint8_t)value;
+            out[1] = (uint8_t)(value >> 8);
+            out[2] = (uint8_t)(value >> 16);
+            out[3] = (uint8_t)(value >> 24);
+        }
+
+        static uint32_t GetU32(const uint8_t* data)
+        {
+            return (uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+        }
+
+        static void WriteVarint(std::vector<uint8_t>& out, uint32_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back((uint8_t)(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back((uint8_t)value);
+        }
+
+        static inline bool ReadVarint(const uint8_t*& data, const uint8_t* end, uint32_t& outValue)
+        {
+            // Most lengths and block ids fit in one byte
+            if (data < end && *data < 0x80)
+            {
+                outValue = *data++;
+                return true;
+            }
+
+            outValue = 0;
+            for (int shift = 0; shift < 35 && data < end; shift += 7)
+            {
+                uint8_t byte = *data++;
+                outValue |= (uint32_t)(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        // Write the runs of a value read per voxel in Index order, y fastest, so runs follow columns
+        template<typename GetValue, typename WriteValue>
+        static void WriteRuns(std::vector<uint8_t>& out, GetValue getValue, WriteValue writeValue)
+        {
+            auto runValue = getValue(0, 0, 0);
+            uint32_t runLength = 0;
+            for (int z = 0; z < CHUNK_SIZE; z++)
+            {
+                for (int x = 0; x < CHUNK_SIZE; x++)
+                {
+                    for (int y = 0; y < CHUNK_SIZE; y++)
+                    {
+                        auto value = getValue(x, y, z);
+                        if (value != runValue)
+                        {
+                            WriteVarint(out, runLength);
+                            writeValue(runValue);
+                            runValue = value;
+                            runLength = 0;
+                        }
+                        runLength++;
+                    }
+                }
+            }
+
+            WriteVarint(out, runLength);
+            writeValue(runValue);
+        }
+
+        void Serialize(const ChunkData& chunkData, std::vector<uint8_t>& out, uint8_t flags)
+        {
+            static thread_local std::vector<uint8_t> body;
+            static thread_local std::vector<uint8_t> blockRuns;
+            static thread_local std::vector<BlockId> palette;
+            static thread_local std::unordered_map<BlockId, uint32_t> paletteIndices;
+            body.clear();
+            blockRuns.clear();
+            palette.clear();
+            paletteIndices.clear();
+
+            // Block runs refer to the palette, which is only complete once every run is written
+            WriteRuns(blockRuns,
+                [&](int x, int y, int z) { return chunkData.Get(x, y, z); },
+                [&](BlockId block) {
+                    auto [it, inserted] = paletteIndices.try_emplace(block, (uint32_t)palette.size());
+                    if (inserted)
+                        palette.push_back(block);
+                    WriteVarint(blockRuns, it->second);
+                });
+
+            WriteVarint(body, (uint32_t)palette.size());
+            for (BlockId block : palette)
+                WriteVarint(body, block);
+            body.insert(body.end(), blockRuns.begin(), blockRuns.end());
+
+            if (flags & INCLUDE_LIGHT)
+            {
+                WriteRuns(body,
+                    [&](int x, int y, int z) { return chunkData.GetPackedLight(x, y, z); },
+                    [&](uint8_t light) { body.push_back(light); });
+            }
+
+            size_t headerOffset = out.size();
+            out.resize(headerOffset + HEADER_SIZE);
+            if (flags & COMPRESS)
+            {
+                LZCompression::Compress(body.data(), body.size(), out);
+
+                // Bodies that don't shrink are stored as they are
+                if (out.size() - headerOffset - HEADER_SIZE >= body.size())
+                {
+                    flags &= ~COMPRESS;
+                    out.resize(headerOffset + HEADER_SIZE);
+                }
+            }
+            if (!(flags & COMPRESS))
+                out.insert(out.end(), body.begin(), body.end());
+
+            uint8_t* header = out.data() + headerOffset;
+            PutU32(&header[0], MAGIC);
+            header[4] = VERSION;
+            header[5] = flags;
+            header[6] = 0;
+            header[7] = 0;
+            PutU32(&header[8], (uint32_t)chunkData.id.x);
+            PutU32(&header[12], (uint32_t)chunkData.id.y);
+            PutU32(&header[16], (uint32_t)chunkData.id.z);
+            PutU32(&header[20], (uint32_t)body.size());
+        }
+
+        static bool IsValidHeader(const uint8_t* data, size_t size)
+        {
+            return size >= HEADER_SIZE && GetU32(&data[0]) == MAGIC && data[4] >= 1 && data[4] <= VERSION;
+        }
+
+        bool GetChunkId(const uint8_t* data, size_t size, glm::ivec3& outId)
+        {
+            if (!IsValidHeader(data, size))
+                return false;
+
+            outId = { (int32_t)GetU32(&data[8]), (int32_t)GetU32(&data[12]), (int32_t)GetU32(&data[16]) };
+            return true;
+        }
+
+        static bool ReadBlocks(const uint8_t*& data, const uint8_t* end, ChunkData& chunkData)
+        {
+            static thread_local std::vector<BlockId> palette;
+
+            uint32_t paletteSize;
+            if (!ReadVarint(data, end, paletteSize) || paletteSize == 0 || paletteSize > CHUNK_VOLUME)
+                return false;
+
+            palette.resize(paletteSize);
+            for (auto& block : palette)
+            {
+                if (!ReadVarint(data, end, block))
+                    return false;
+            }
+
+            // Size the storage once instead of growing it as new blocks show up. Air is already in it.
+            bool hasAir = std::find(palette.begin(), palette.end(), 0) != palette.end();
+            chunkData.ReserveBlockPalette(hasAir ? paletteSize : paletteSize + 1);
+
+            int index = 0;
+            while (index < CHUNK_VOLUME)
+            {
+                uint32_t runLength, paletteIndex;
+                if (!ReadVarint(data, end, runLength) || !ReadVarint(data, end, paletteIndex) ||
+                    runLength == 0 || runLength > (uint32_t)(CHUNK_VOLUME - index) || paletteIndex >= paletteSize)
+                    return false;
+
+                // A single run is a uniform chunk, which doesn't need any per-voxel storage
+                if (runLength == CHUNK_VOLUME)
+                    chunkData.FillBlocks(palette[paletteIndex]);
+                else
+                    chunkData.FillAirRun(index, (int)runLength, palette[paletteIndex]);
+                index += runLength;
+            }
+
+            chunkData.Compact();
+            return true;
+        }
+
+        static bool ReadLight(const uint8_t*& data, const uint8_t* end, ChunkData& chunkData)
+        {
+            static thread_local auto light = std::make_unique<uint8_t[]>(CHUNK_VOLUME);
+
+            // Uniform light doesn't need the per-voxel array
+            uint32_t runLength;
+            const uint8_t* first = data;
+            if (ReadVarint(first, end, runLength) && runLength == CHUNK_VOLUME && first < end)
+            {
+                chunkData.FillLight(*first & 0x0F, *first >> 4);
+                data = first + 1;
+                return true;
+            }
+
+            int index = 0;
+            while (index < CHUNK_VOLUME)
+            {
+                if (!ReadVarint(data, end, runLength) || data >= end ||
+                    runLength == 0 || runLength > (uint32_t)(CHUNK_VOLUME - index))
+                    return false;
+
+                std::memset(&light[index], *data++, runLength);
+                index += runLength;
+            }
+
+            chunkData.LoadPackedLight(light.get());
+            return true;
+        }
+
+        bool Deserialize(const uint8_t* data, size_t size, ChunkData& chunkData)
+        {
+            chunkData.ClearBlocks();
+            if (!IsValidHeader(data, size))
+                return false;
+
+            uint8_t flags = data[5];
+            uint32_t bodySize = GetU32(&data[20]);
+            if (bodySize > MAX_BODY_SIZE)
+                return false;
+
+            const uint8_t* body = data + HEADER_SIZE;
+            if (flags & COMPRESS)
+            {
+                static thread_local std::vector<uint8_t> buffer;
+                buffer.resize(bodySize);
+                if (!LZCompression::Decompress(body, size - HEADER_SIZE, buffer.data(), bodySize))
+                    return false;
+                body = buffer.data();
+            }
+            else if (size - HEADER_SIZE != bodySize)
+            {
+                return false;
+            }
+
+            const uint8_t* end = body + bodySize;
+            if (!ReadBlocks(body, end, chunkData) ||
+                ((flags & INCLUDE_LIGHT) && !ReadLight(body, end, chunkData)) ||
+                body != end)
+            {
+                chunkData.ClearBlocks();
+                return false;
+            }
+
+            return true;
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#include <wv/voxel_worlds/ChunkUploadQueue.h>
+#include <algorithm>
+
+namespace WillowVox
+{
+    ChunkUploadQueue::ChunkUploadQueue(uint32_t frameBudget, int regionCount)
+        : m_frameBudget(frameBudget), m_regions(std::max(regionCount, 1))
+    {
+    }
+
+    void ChunkUploadQueue::Enqueue(Key key, uint32_t size)
+    {
+        auto [it, inserted] = m_queued.try_emplace(key, size);
+        if (inserted)
+        {
+            m_order.push_back(key);
+        }
+        else
+        {
+            m_queuedBytes -= it->second;
+            it->second = size;
+        }
+        m_queuedBytes += size;
+    }
+
+    void ChunkUploadQueue::Cancel(Key key)
+    {
+        auto it = m_queued.find(key);
+        if (it == m_queued.end())
+            return;
+
+        m_queuedBytes -= it->second;
+        m_queued.erase(it);
+    }
+
+    bool ChunkUploadQueue::BeginFrame(const std::function<bool(uint64_t fence)>& fenceSignalled)
+    {
+        m_currentRegion = (m_currentRegion + 1) % (int)m_regions.size();
+        m_frameBytes = 0;
+        m_frameStaged = false;
+
+        Region& region = m_regions[m_currentRegion];
+        if (region.busy)
+        {
+            if (!fenceSignalled(region.fence))
+            {
+                m_frameOpen = false;
+                return false;
+            }
+
+            region.busy = false;
+            region.fence = 0;
+        }
+
+        m_frameOpen = true;
+        return true;
+    }
+
+    bool ChunkUploadQueue::Next(Upload& outUpload)
+    {
+        if (!m_frameOpen)
+            return false;
+
+        while (!m_order.empty())
+        {
+            Key key = m_order.front();
+            auto it = m_queued.find(key);
+            if (it == m_queued.end())
+            {
+                // Cancelled
+                m_order.pop_front();
+                continue;
+            }
+
+            uint32_t size = it->second;
+            bool staged = size <= m_frameBudget;
+            if (staged ? m_frameBytes + size > m_frameBudget : m_frameBytes > 0)
+                return false;
+
+            outUpload = { key, size, (uint32_t)m_currentRegion * m_frameBudget + m_frameBytes, staged };
+
+            // An oversized upload uses up the whole frame
+            m_frameBytes += staged ? size : m_frameBudget;
+            m_frameStaged |= staged && size > 0;
+            m_queuedBytes -= size;
+            m_queued.erase(it);
+            m_order.pop_front();
+            return true;
+        }
+
+        return false;
+    }
+
+    void ChunkUploadQueue::EndFrame(const std::function<uint64_t()>& createFence)
+    {
+        if (m_frameOpen && m_frameStaged)
+        {
+            Region& region = m_regions[m_currentRegion];
+            region.fence = createFence();
+            region.busy = true;
+        }
+
+        m_frameOpen = false;
+    }
+
+    void ChunkUploadQueue::ReleaseFences(const std::function<void(uint64_t fence)>& release)
+    {
+        for (auto& region : m_regions)
+        {
+            if (region.busy)
+                release(region.fence);
+            region = Region();
+        }
+    }
+}
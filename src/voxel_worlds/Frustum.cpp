@@ -0,0 +1,40 @@
+#include <wv/voxel_worlds/Frustum.h>
+
+namespace WillowVox
+{
+    Frustum Frustum::FromMatrix(const glm::mat4& viewProjection)
+    {
+        // glm matrices are column major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+        auto row = [&](int i) {
+            return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+        };
+
+        glm::vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+
+        Frustum frustum;
+        frustum.m_planes[0] = w + x; // Left
+        frustum.m_planes[1] = w - x; // Right
+        frustum.m_planes[2] = w + y; // Bottom
+        frustum.m_planes[3] = w - y; // Top
+        frustum.m_planes[4] = w + z; // Near
+        frustum.m_planes[5] = w - z; // Far
+        return frustum;
+    }
+
+    bool Frustum::IntersectsBox(const glm::vec3& min, const glm::vec3& max) const
+    {
+        for (auto& plane : m_planes)
+        {
+            // Test the corner furthest along the plane normal
+            glm::vec3 corner = {
+                plane.x >= 0.0f ? max.x : min.x,
+                plane.y >= 0.0f ? max.y : min.y,
+                plane.z >= 0.0f ? max.z : min.z
+            };
+            if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f)
+                return false;
+        }
+
+        return true;
+    }
+}
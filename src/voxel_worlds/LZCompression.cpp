@@ -0,0 +1,169 @@
+#include <wv/voxel_worlds/LZCompression.h>
+#include <algorithm>
+#include <cstring>
+
+namespace WillowVox
+{
+    namespace LZCompression
+    {
+        static constexpr int HASH_BITS = 12;
+        static constexpr size_t MAX_OFFSET = 65535;
+        // After this many bytes without a match the search starts skipping ahead
+        static constexpr int SKIP_SHIFT = 6;
+
+        static inline uint32_t Load32(const uint8_t* data)
+        {
+            uint32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        static inline uint32_t Hash(uint32_t sequence)
+        {
+            return (sequence * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        static void WriteLength(std::vector<uint8_t>& out, size_t length)
+        {
+            while (length >= 255)
+            {
+                out.push_back(255);
+                length -= 255;
+            }
+            out.push_back((uint8_t)length);
+        }
+
+        static void WriteSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength)
+        {
+            size_t matchCode = matchLength - MIN_MATCH;
+            out.push_back((uint8_t)(std::min<size_t>(literalLength, 15) << 4 | std::min<size_t>(matchCode, 15)));
+            if (literalLength >= 15)
+                WriteLength(out, literalLength - 15);
+            out.insert(out.end(), literals, literals + literalLength);
+
+            out.push_back((uint8_t)offset);
+            out.push_back((uint8_t)(offset >> 8));
+            if (matchCode >= 15)
+                WriteLength(out, matchCode - 15);
+        }
+
+        void Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+        {
+            uint32_t table[1 << HASH_BITS] = {};
+
+            size_t anchor = 0;
+            size_t pos = 1;
+            while (pos + MIN_MATCH <= size)
+            {
+                uint32_t sequence = Load32(data + pos);
+                uint32_t& slot = table[Hash(sequence)];
+                size_t candidate = slot;
+                slot = (uint32_t)pos;
+
+                if (pos - candidate > MAX_OFFSET || Load32(data + candidate) != sequence)
+                {
+                    pos += 1 + ((pos - anchor) >> SKIP_SHIFT);
+                    continue;
+                }
+
+                // Extend the match backwards over pending literals and then forwards
+                while (pos > anchor && candidate > 0 && data[pos - 1] == data[candidate - 1])
+                {
+                    pos--;
+                    candidate--;
+                }
+                size_t length = MIN_MATCH;
+                while (pos + length < size && data[candidate + length] == data[pos + length])
+                    length++;
+
+                WriteSequence(out, data + anchor, pos - anchor, pos - candidate, length);
+                pos += length;
+                anchor = pos;
+            }
+
+            // The last sequence only has literals, the decoder stops when the input runs out
+            size_t literalLength = size - anchor;
+            out.push_back((uint8_t)(std::min<size_t>(literalLength, 15) << 4));
+            if (literalLength >= 15)
+                WriteLength(out, literalLength - 15);
+            out.insert(out.end(), data + anchor, data + size);
+        }
+
+        static inline bool ReadLength(const uint8_t*& in, const uint8_t* end, size_t& length)
+        {
+            uint8_t byte;
+            do
+            {
+                if (in >= end)
+                    return false;
+                byte = *in++;
+                length += byte;
+            } while (byte == 255);
+            return true;
+        }
+
+        bool Decompress(const uint8_t* data, size_t size, uint8_t* out, size_t outSize)
+        {
+            const uint8_t* in = data;
+            const uint8_t* inEnd = data + size;
+            uint8_t* op = out;
+            uint8_t* outEnd = out + outSize;
+
+            // The stream always ends with a literal-only sequence, input that stops anywhere else
+            // was cut short
+            while (true)
+            {
+                if (in >= inEnd)
+                    return false;
+                uint8_t token = *in++;
+
+                size_t literalLength = token >> 4;
+                if (literalLength == 15 && !ReadLength(in, inEnd, literalLength))
+                    return false;
+                if (literalLength > (size_t)(inEnd - in) || literalLength > (size_t)(outEnd - op))
+                    return false;
+                std::memcpy(op, in, literalLength);
+                in += literalLength;
+                op += literalLength;
+
+                if (in == inEnd)
+                    return op == outEnd;
+
+                if (inEnd - in < 2)
+                    return false;
+                size_t offset = in[0] | (size_t)in[1] << 8;
+                in += 2;
+
+                size_t matchLength = token & 15;
+                if (matchLength == 15 && !ReadLength(in, inEnd, matchLength))
+                    return false;
+                matchLength += MIN_MATCH;
+
+                if (offset == 0 || offset > (size_t)(op - out) || matchLength > (size_t)(outEnd - op))
+                    return false;
+
+                // Copies from far enough back don't overlap and go in 8-byte steps, close ones
+                // repeat a short pattern and go byte by byte
+                const uint8_t* match = op - offset;
+                if (offset >= 8)
+                {
+                    uint8_t* copyEnd = op + matchLength;
+                    while (op + 8 <= copyEnd)
+                    {
+                        std::memcpy(op, match, 8);
+                        op += 8;
+                        match += 8;
+                    }
+                    while (op < copyEnd)
+                        *op++ = *match++;
+                }
+                else
+                {
+                    for (size_t i = 0; i < matchLength; i++)
+                        op[i] = match[i];
+                    op += matchLength;
+                }
+            }
+        }
+    }
+}
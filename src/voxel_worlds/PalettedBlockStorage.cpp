@@ -0,0 +1,314 @@
+#include <wv/voxel_worlds/PalettedBlockStorage.h>
+#include <algorithm>
+#include <unordered_set>
+
+namespace WillowVox
+{
+    // Widest palette index, wider layouts store the block ids themselves
+    static constexpr int MAX_PALETTE_BITS = 8;
+    static constexpr size_t MAX_PALETTE_SIZE = size_t(1) << MAX_PALETTE_BITS;
+    static constexpr int RAW_BITS = sizeof(BlockId) * 8;
+    static_assert(64 % RAW_BITS == 0, "Raw block ids must not straddle two words");
+    static constexpr size_t LINEAR_LOOKUP_LIMIT = 16;
+
+    PalettedBlockStorage::Layout::Layout(int bitsPerIndex)
+        : bitsPerIndex(bitsPerIndex), indexMask((1ull << bitsPerIndex) - 1), raw(bitsPerIndex > MAX_PALETTE_BITS),
+        palette(raw ? nullptr : std::make_unique<BlockId[]>(size_t(1) << bitsPerIndex))
+    {
+        if (bitsPerIndex > 0)
+            words = std::make_unique<std::atomic<uint64_t>[]>(CHUNK_VOLUME * bitsPerIndex / 64);
+    }
+
+    PalettedBlockStorage::PalettedBlockStorage(BlockId fillValue)
+    {
+        Fill(fillValue);
+    }
+
+    void PalettedBlockStorage::Fill(BlockId value)
+    {
+        auto layout = std::make_unique<Layout>(0);
+        layout->palette[0] = value;
+
+        m_layout.store(layout.get(), std::memory_order_release);
+        m_currentLayout = std::move(layout);
+        m_retiredLayouts.clear();
+
+        m_paletteSize = 1;
+        m_paletteLookup.clear();
+    }
+
+    int PalettedBlockStorage::FindPaletteIndex(BlockId value) const
+    {
+        if (m_paletteSize <= LINEAR_LOOKUP_LIMIT)
+        {
+            for (size_t i = 0; i < m_paletteSize; ++i)
+            {
+                if (m_currentLayout->palette[i] == value)
+                    return (int)i;
+            }
+            return -1;
+        }
+
+        auto it = m_paletteLookup.find(value);
+        return it == m_paletteLookup.end() ? -1 : it->second;
+    }
+
+    uint64_t PalettedBlockStorage::GetOrAddPaletteIndex(BlockId value)
+    {
+        if (m_currentLayout->raw)
+            return value;
+
+        int paletteIndex = FindPaletteIndex(value);
+        if (paletteIndex < 0)
+        {
+            if (m_paletteSize == (size_t(1) << m_currentLayout->bitsPerIndex))
+            {
+                Grow();
+                if (m_currentLayout->raw)
+                    return value;
+            }
+
+            paletteIndex = (int)m_paletteSize;
+            m_currentLayout->palette[m_paletteSize++] = value;
+
+            if (m_paletteSize > LINEAR_LOOKUP_LIMIT)
+            {
+                if (m_paletteLookup.empty())
+                {
+                    for (size_t i = 0; i < m_paletteSize; ++i)
+                        m_paletteLookup[m_currentLayout->palette[i]] = (uint16_t)i;
+                }
+                else
+                    m_paletteLookup[value] = (uint16_t)paletteIndex;
+            }
+        }
+
+        return (uint64_t)paletteIndex;
+    }
+
+    void PalettedBlockStorage::Set(int index, BlockId value)
+    {
+        if (Get(index) == value)
+            return;
+
+        uint64_t paletteIndex = GetOrAddPaletteIndex(value);
+
+        // Write the packed index. The palette entry is written first so a reader that sees the
+        // new index also sees the block id it refers to.
+        Layout* layout = m_currentLayout.get();
+        int bit = index * layout->bitsPerIndex;
+        int shift = bit & 63;
+        auto& word = layout->words[bit >> 6];
+        uint64_t packed = word.load(std::memory_order_relaxed);
+        packed = (packed & ~(layout->indexMask << shift)) | (paletteIndex << shift);
+        word.store(packed, std::memory_order_release);
+    }
+
+    void PalettedBlockStorage::SetRange(int index, int count, BlockId value)
+    {
+        if (count <= 0)
+            return;
+        if (IsUniform() && m_currentLayout->palette[0] == value)
+            return;
+
+        uint64_t paletteIndex = GetOrAddPaletteIndex(value);
+        Layout* layout = m_currentLayout.get();
+
+        // Index widths divide 64, so the index repeated across a whole word is a multiplication
+        uint64_t pattern = paletteIndex * (~0ull / layout->indexMask);
+        int bit = index * layout->bitsPerIndex;
+        int endBit = (index + count) * layout->bitsPerIndex;
+
+        auto writeBits = [&](int word, uint64_t mask) {
+            auto& target = layout->words[word];
+            uint64_t packed = target.load(std::memory_order_relaxed);
+            target.store((packed & ~mask) | (pattern & mask), std::memory_order_release);
+        };
+
+        // Partial words at either end, whole words in between
+        int firstWord = bit >> 6;
+        int lastWord = (endBit - 1) >> 6;
+        uint64_t firstMask = ~0ull << (bit & 63);
+        uint64_t lastMask = ~0ull >> (63 - ((endBit - 1) & 63));
+        if (firstWord == lastWord)
+        {
+            writeBits(firstWord, firstMask & lastMask);
+            return;
+        }
+
+        writeBits(firstWord, firstMask);
+        for (int word = firstWord + 1; word < lastWord; word++)
+            layout->words[word].store(pattern, std::memory_order_release);
+        writeBits(lastWord, lastMask);
+    }
+
+    void PalettedBlockStorage::Reserve(size_t paletteSize)
+    {
+        int bits = m_currentLayout->bitsPerIndex;
+        int newBits = bits;
+        if (paletteSize > MAX_PALETTE_SIZE)
+            newBits = RAW_BITS;
+        while ((size_t(1) << newBits) < paletteSize)
+            newBits = newBits == 0 ? 1 : newBits * 2;
+
+        if (newBits > bits)
+            m_retiredLayouts.push_back(Rebuild(newBits, false));
+    }
+
+    void PalettedBlockStorage::Grow()
+    {
+        // The raw layout never grows, so this retires at most one layout per width
+        int bits = m_currentLayout->bitsPerIndex;
+        int newBits = bits == 0 ? 1 : bits * 2;
+        m_retiredLayouts.push_back(Rebuild(newBits > MAX_PALETTE_BITS ? RAW_BITS : newBits, false));
+    }
+
+    void PalettedBlockStorage::Compact()
+    {
+        if (m_currentLayout->bitsPerIndex == 0)
+            return;
+
+        // Nothing reads concurrently, so the retired layouts can go
+        m_retiredLayouts.clear();
+
+        if (m_currentLayout->raw)
+        {
+            // Go back to a palette if few enough block types are left
+            std::unordered_set<BlockId> distinct;
+            for (int i = 0; i < CHUNK_VOLUME && distinct.size() <= MAX_PALETTE_SIZE; ++i)
+                distinct.insert((BlockId)GetPaletteIndex(*m_currentLayout, i));
+
+            if (distinct.size() == 1)
+                Fill(*distinct.begin());
+            else if (distinct.size() <= MAX_PALETTE_SIZE)
+                Rebuild(GetBitsForPaletteSize(distinct.size()), true);
+            return;
+        }
+
+        // Count the palette entries that are still referenced
+        std::vector<bool> used(m_paletteSize, false);
+        size_t usedCount = 0;
+        for (int i = 0; i < CHUNK_VOLUME && usedCount < m_paletteSize; ++i)
+        {
+            uint64_t paletteIndex = GetPaletteIndex(*m_currentLayout, i);
+            if (!used[paletteIndex])
+            {
+                used[paletteIndex] = true;
+                ++usedCount;
+            }
+        }
+
+        if (usedCount == 1)
+        {
+            for (size_t i = 0; i < m_paletteSize; ++i)
+            {
+                if (used[i])
+                {
+                    Fill(m_currentLayout->palette[i]);
+                    return;
+                }
+            }
+        }
+
+        int newBits = GetBitsForPaletteSize(usedCount);
+        if (usedCount == m_paletteSize && newBits == m_currentLayout->bitsPerIndex)
+            return;
+
+        Rebuild(newBits, true);
+    }
+
+    int PalettedBlockStorage::GetBitsForPaletteSize(size_t paletteSize)
+    {
+        int bits = 1;
+        while ((size_t(1) << bits) < paletteSize)
+            bits *= 2;
+        return bits;
+    }
+
+    uint64_t PalettedBlockStorage::GetPaletteIndex(const Layout& layout, int index)
+    {
+        if (layout.bitsPerIndex == 0)
+            return 0;
+
+        int bit = index * layout.bitsPerIndex;
+        return (layout.words[bit >> 6].load(std::memory_order_relaxed) >> (bit & 63)) & layout.indexMask;
+    }
+
+    std::unique_ptr<PalettedBlockStorage::Layout> PalettedBlockStorage::Rebuild(int newBits, bool dropUnused)
+    {
+        Layout* oldLayout = m_currentLayout.get();
+        auto newLayout = std::make_unique<Layout>(newBits);
+
+        // Leaving the raw layout builds a palette from the block ids in use, which the caller
+        // has checked fit the new width
+        bool fromRaw = oldLayout->raw;
+        dropUnused = dropUnused && !newLayout->raw;
+        bool newPalette = dropUnused || newLayout->raw;
+
+        size_t newPaletteSize = m_paletteSize;
+        std::vector<int> remap;
+        std::unordered_map<BlockId, int> rawRemap;
+        if (newPalette)
+        {
+            if (!fromRaw)
+                remap.assign(m_paletteSize, -1);
+            newPaletteSize = 0;
+        }
+        else
+        {
+            for (size_t i = 0; i < m_paletteSize; ++i)
+                newLayout->palette[i] = oldLayout->palette[i];
+        }
+
+        // A uniform layout has every index at 0, which is what the new words already hold
+        bool repack = oldLayout->bitsPerIndex > 0 || newPalette;
+
+        // Repack every index at the new width
+        for (int i = 0; i < CHUNK_VOLUME && repack; ++i)
+        {
+            uint64_t paletteIndex = GetPaletteIndex(*oldLayout, i);
+
+            if (newLayout->raw)
+                paletteIndex = oldLayout->palette[paletteIndex];
+            else if (fromRaw)
+            {
+                auto [it, added] = rawRemap.try_emplace((BlockId)paletteIndex, (int)newPaletteSize);
+                if (added)
+                    newLayout->palette[newPaletteSize++] = (BlockId)paletteIndex;
+                paletteIndex = it->second;
+            }
+            else if (dropUnused)
+            {
+                if (remap[paletteIndex] < 0)
+                {
+                    remap[paletteIndex] = (int)newPaletteSize;
+                    newLayout->palette[newPaletteSize++] = oldLayout->palette[paletteIndex];
+                }
+                paletteIndex = remap[paletteIndex];
+            }
+
+            if (paletteIndex == 0)
+                continue;
+
+            int bit = i * newBits;
+            auto& word = newLayout->words[bit >> 6];
+            word.store(word.load(std::memory_order_relaxed) | (paletteIndex << (bit & 63)), std::memory_order_relaxed);
+        }
+
+        if (newPalette)
+        {
+            m_paletteSize = newPaletteSize;
+            m_paletteLookup.clear();
+            if (m_paletteSize > LINEAR_LOOKUP_LIMIT)
+            {
+                for (size_t i = 0; i < m_paletteSize; ++i)
+                    m_paletteLookup[newLayout->palette[i]] = (uint16_t)i;
+            }
+        }
+
+        // Publish the new layout and hand the old one back so it can outlive concurrent readers
+        m_layout.store(newLayout.get(), std::memory_order_release);
+        std::swap(m_currentLayout, newLayout);
+        return newLayout;
+    }
+}
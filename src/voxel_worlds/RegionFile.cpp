@@ -0,0 +1,210 @@
+#include <wv/voxel_worlds/RegionFile.h>
+#include <wv/core.h>
+
+namespace WillowVox
+{
+    // Files with less garbage than this are never compacted
+    static constexpr uint64_t MIN_COMPACT_GARBAGE = 1 << 20;
+
+    static void PutU32(uint8_t* out, uint32_t value)
+    {
+        out[0] = (uint8_t)value;
+        out[1] = (uint8_t)(value >> 8);
+        out[2] = (uint8_t)(value >> 16);
+        out[3] = (uint8_t)(value >> 24);
+    }
+
+    static uint32_t GetU32(const uint8_t* data)
+    {
+        return (uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+    }
+
+    RegionFile::RegionFile(std::filesystem::path path)
+        : m_path(std::move(path))
+    {
+        std::error_code error;
+        if (!std::filesystem::exists(m_path, error))
+            return;
+
+        const uint8_t* header = m_mapping.Open(m_path) ? m_mapping.GetData() : nullptr;
+        if (!header || m_mapping.GetSize() < HEADER_SIZE || GetU32(&header[0]) != MAGIC || GetU32(&header[4]) != VERSION)
+        {
+            Logger::Warn("Region file '%s' is invalid and will be overwritten", m_path.string().c_str());
+            m_mapping.Close();
+            return;
+        }
+
+        m_fileSize = m_mapping.GetSize();
+        for (int i = 0; i < CHUNKS_PER_REGION; i++)
+        {
+            Entry& entry = m_entries[i];
+            entry.offset = GetU32(&header[8 + i * 8]);
+            entry.size = GetU32(&header[12 + i * 8]);
+
+            // Drop entries pointing past the end of a truncated file
+            if (entry.offset < HEADER_SIZE || entry.offset + (uint64_t)entry.size > m_fileSize)
+                entry = Entry();
+            m_liveBytes += entry.size;
+        }
+    }
+
+    bool RegionFile::Read(int chunkIndex, const uint8_t*& outData, uint32_t& outSize)
+    {
+        const Entry& entry = m_entries[chunkIndex];
+        if (entry.size == 0)
+            return false;
+
+        if (!m_mapping.IsOpen() && !m_mapping.Open(m_path))
+            return false;
+        if (entry.offset + (uint64_t)entry.size > m_mapping.GetSize())
+            return false;
+
+        outData = m_mapping.GetData() + entry.offset;
+        outSize = entry.size;
+        return true;
+    }
+
+    bool RegionFile::Write(int chunkIndex, const uint8_t* data, uint32_t size)
+    {
+        // The mapping may not cover the new end of the file, and on Windows a mapped file can't
+        // be replaced by compaction
+        m_mapping.Close();
+
+        if (!m_file.is_open())
+        {
+            // Files that didn't exist or were invalid start over with an empty table
+            if (m_fileSize == 0)
+            {
+                if (!Create())
+                    return false;
+            }
+            else
+            {
+                m_file.open(m_path, std::ios::in | std::ios::out | std::ios::binary);
+                if (!m_file.is_open())
+                    return false;
+            }
+        }
+
+        // Rewrites that fit reuse the old payload's space, anything else goes at the end
+        Entry& entry = m_entries[chunkIndex];
+        uint32_t offset = entry.size >= size && entry.offset != 0 ? entry.offset : (uint32_t)m_fileSize;
+
+        m_file.clear();
+        m_file.seekp(offset);
+        if (!m_file.write((const char*)data, size))
+            return false;
+
+        // The table is only updated once the payload is written
+        m_liveBytes = m_liveBytes - entry.size + size;
+        entry.offset = size > 0 ? offset : 0;
+        entry.size = size;
+        m_fileSize = std::max(m_fileSize, (uint64_t)offset + size);
+        if (!WriteEntry(chunkIndex))
+            return false;
+        m_file.flush();
+
+        // A failed compaction leaves the current file in place, so the write still succeeded
+        uint64_t garbage = m_fileSize - HEADER_SIZE - m_liveBytes;
+        if (garbage > m_liveBytes && garbage >= MIN_COMPACT_GARBAGE)
+            Compact();
+        return true;
+    }
+
+    bool RegionFile::Create()
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_path.parent_path(), error);
+
+        // Write an empty table, then reopen for reading and writing
+        {
+            std::vector<uint8_t> header(HEADER_SIZE, 0);
+            PutU32(&header[0], MAGIC);
+            PutU32(&header[4], VERSION);
+
+            std::ofstream file(m_path, std::ios::binary | std::ios::trunc);
+            if (!file.write((const char*)header.data(), HEADER_SIZE))
+            {
+                Logger::Warn("Failed to create region file '%s'", m_path.string().c_str());
+                return false;
+            }
+        }
+
+        for (auto& entry : m_entries)
+            entry = Entry();
+        m_fileSize = HEADER_SIZE;
+        m_liveBytes = 0;
+
+        m_file.open(m_path, std::ios::in | std::ios::out | std::ios::binary);
+        return m_file.is_open();
+    }
+
+    bool RegionFile::WriteEntry(int chunkIndex)
+    {
+        uint8_t bytes[8];
+        PutU32(&bytes[0], m_entries[chunkIndex].offset);
+        PutU32(&bytes[4], m_entries[chunkIndex].size);
+
+        m_file.seekp(8 + chunkIndex * 8);
+        return (bool)m_file.write((const char*)bytes, sizeof(bytes));
+    }
+
+    bool RegionFile::Compact()
+    {
+        // Copy the live payloads back to back into a new file, then swap it in
+        std::filesystem::path compactPath = m_path;
+        compactPath += ".tmp";
+
+        std::vector<uint8_t> header(HEADER_SIZE, 0);
+        PutU32(&header[0], MAGIC);
+        PutU32(&header[4], VERSION);
+
+        std::vector<uint8_t> payloads;
+        payloads.reserve(m_liveBytes);
+        Entry entries[CHUNKS_PER_REGION];
+        for (int i = 0; i < CHUNKS_PER_REGION; i++)
+        {
+            const uint8_t* payload;
+            uint32_t size;
+            if (m_entries[i].size == 0)
+                continue;
+            if (!Read(i, payload, size))
+                return false;
+
+            entries[i] = { (uint32_t)(HEADER_SIZE + payloads.size()), size };
+            PutU32(&header[8 + i * 8], entries[i].offset);
+            PutU32(&header[12 + i * 8], entries[i].size);
+            payloads.insert(payloads.end(), payload, payload + size);
+        }
+        m_mapping.Close();
+
+        {
+            std::ofstream file(compactPath, std::ios::binary | std::ios::trunc);
+            if (!file.write((const char*)header.data(), HEADER_SIZE) ||
+                !file.write((const char*)payloads.data(), payloads.size()))
+            {
+                Logger::Warn("Failed to compact region file '%s'", m_path.string().c_str());
+                return false;
+            }
+        }
+
+        m_file.close();
+        std::error_code error;
+        std::filesystem::rename(compactPath, m_path, error);
+
+        // Once the new file is in place the table has to describe it, even if reopening fails
+        if (!error)
+        {
+            std::copy(std::begin(entries), std::end(entries), m_entries);
+            m_fileSize = HEADER_SIZE + payloads.size();
+        }
+
+        m_file.open(m_path, std::ios::in | std::ios::out | std::ios::binary);
+        if (error || !m_file.is_open())
+        {
+            Logger::Warn("Failed to replace region file '%s'", m_path.string().c_str());
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,81 @@
+#include <wv/voxel_worlds/RegionStore.h>
+#include <wv/voxel_worlds/ChunkSerializer.h>
+#include <string>
+
+namespace WillowVox
+{
+    RegionStore::RegionStore(std::filesystem::path directory)
+        : m_directory(std::move(directory))
+    {
+    }
+
+    bool RegionStore::Load(ChunkData& chunkData)
+    {
+        auto region = GetRegion(RegionFile::GetRegionId(chunkData.id));
+        int chunkIndex = RegionFile::GetChunkIndex(chunkData.id);
+
+        // Decode straight out of the mapped file, which has to stay mapped until decoding is done
+        std::lock_guard<std::mutex> lock(region->mutex);
+        const uint8_t* payload;
+        uint32_t size;
+        if (!region->file.Contains(chunkIndex) || !region->file.Read(chunkIndex, payload, size))
+            return false;
+
+        if (!ChunkSerializer::Deserialize(payload, size, chunkData))
+        {
+            Logger::Warn("Saved chunk (%d, %d, %d) is corrupt and will be regenerated", chunkData.id.x, chunkData.id.y, chunkData.id.z);
+            return false;
+        }
+        return true;
+    }
+
+    bool RegionStore::Save(const ChunkData& chunkData)
+    {
+        static thread_local std::vector<uint8_t> payload;
+        payload.clear();
+        // Light is calculated again when a chunk is loaded, so only the blocks are stored
+        // The palette and runs already take most chunks down to a few hundred bytes, so the body
+        // isn't LZ compressed and Load decodes it straight from the mapped file without a copy.
+        // Payloads saved compressed by older versions still load.
+        ChunkSerializer::Serialize(chunkData, payload, 0);
+
+        auto region = GetRegion(RegionFile::GetRegionId(chunkData.id));
+        std::lock_guard<std::mutex> lock(region->mutex);
+        if (!region->file.Write(RegionFile::GetChunkIndex(chunkData.id), payload.data(), (uint32_t)payload.size()))
+        {
+            Logger::Warn("Failed to save chunk (%d, %d, %d)", chunkData.id.x, chunkData.id.y, chunkData.id.z);
+            return false;
+        }
+        return true;
+    }
+
+    std::shared_ptr<RegionStore::Region> RegionStore::GetRegion(const glm::ivec3& regionId)
+    {
+        std::lock_guard<std::mutex> lock(m_regionsMutex);
+
+        auto& region = m_regions[regionId];
+        if (!region)
+        {
+            // Close the least recently used region nobody else is using, so two handles never
+            // point at the same file
+            if (m_regions.size() > MAX_OPEN_REGIONS)
+            {
+                auto oldest = m_regions.end();
+                for (auto it = m_regions.begin(); it != m_regions.end(); ++it)
+                {
+                    if (it->second && it->second.use_count() == 1 &&
+                        (oldest == m_regions.end() || it->second->lastUse < oldest->second->lastUse))
+                        oldest = it;
+                }
+                if (oldest != m_regions.end())
+                    m_regions.erase(oldest);
+            }
+
+            std::string name = "r." + std::to_string(regionId.x) + "." + std::to_string(regionId.y) + "." + std::to_string(regionId.z) + ".wvr";
+            region = std::make_shared<Region>(m_directory / name);
+        }
+
+        region->lastUse = ++m_useCounter;
+        return region;
+    }
+}
@@ -6,8 +6,78 @@
 
 namespace WillowVox::VoxelLighting
 {
-    std::mutex lightingMutex;
-    std::mutex skyLightingMutex;
+    // One bit of a RegionLock stripe mask per mutex
+    static constexpr int LOCK_STRIPES = 64;
+    static std::mutex s_blockLightStripes[LOCK_STRIPES];
+    static std::mutex s_skyLightStripes[LOCK_STRIPES];
+
+    // Columns tile the stripes 8 x 8, so columns less than 8 apart on either axis never share one
+    static int GetColumnStripe(int x, int z)
+    {
+        return (x & 7) | (z & 7) << 3;
+    }
+
+    RegionLock::RegionLock(const std::vector<glm::ivec3>& chunkIds, LightChannels channels)
+        : m_channels(channels)
+    {
+        uint64_t stripes = 0;
+        for (auto& id : chunkIds)
+        {
+            for (int x = id.x - 1; x <= id.x + 1; x++)
+            {
+                for (int z = id.z - 1; z <= id.z + 1; z++)
+                    stripes |= 1ull << GetColumnStripe(x, z);
+            }
+        }
+        Lock(stripes, channels);
+    }
+
+    RegionLock::RegionLock(const glm::ivec3& chunkId, LightChannels channels)
+        : RegionLock(std::vector<glm::ivec3>{ chunkId }, channels)
+    {}
+
+    RegionLock::RegionLock(LightChannels channels)
+        : m_channels(channels)
+    {
+        Lock(~0ull, channels);
+    }
+
+    void RegionLock::Lock(uint64_t stripes, LightChannels channels)
+    {
+        // Block light stripes before sky light stripes, each in ascending order, so two locks
+        // can never wait on each other
+        if (channels & BlockLight)
+        {
+            for (int i = 0; i < LOCK_STRIPES; i++)
+            {
+                if (stripes >> i & 1)
+                    s_blockLightStripes[i].lock();
+            }
+        }
+        if (channels & SkyLight)
+        {
+            for (int i = 0; i < LOCK_STRIPES; i++)
+            {
+                if (stripes >> i & 1)
+                    s_skyLightStripes[i].lock();
+            }
+        }
+        m_stripes = stripes;
+    }
+
+    RegionLock::~RegionLock()
+    {
+        for (int i = LOCK_STRIPES - 1; i >= 0; i--)
+        {
+            if (!(m_stripes >> i & 1))
+                continue;
+
+            if (m_channels & SkyLight)
+                s_skyLightStripes[i].unlock();
+            if (m_channels & BlockLight)
+                s_blockLightStripes[i].unlock();
+        }
+    }
 
     struct LightNode
     {
@@ -364,163 +434,8 @@ namespace WillowVox::VoxelLighting
         }
     }
 
-    std::unordered_set<glm::ivec3> CalculateFullLighting(ChunkManager* chunkManager, ChunkData* chunkData)
-    {
-        chunkData->ClearLight();
-
-        // Create lighting queues
-        std::queue<LightNode> skyLightQueue;
-
-        // If empty and above 0, start sky lighting
-        if (chunkData->IsEmpty() && chunkData->id.y > 0)
-        {
-            for (int x = 0; x < CHUNK_SIZE; ++x)
-            {
-                for (int z = 0; z < CHUNK_SIZE; ++z)
-                {
-                    // Set sky light level to maximum and enqueue
-                    chunkData->SetSkyLightLevel(x, CHUNK_SIZE - 1, z, 15);
-                    skyLightQueue.emplace(x, CHUNK_SIZE - 1, z, chunkData);
-                }
-            }
-        }
-        else
-        {
-            // Add edges of neighbors to sky light queue
-            // Positive Y
-            {
-                ChunkData* neighborChunk = chunkManager->GetChunkData(chunkData->id + glm::ivec3(0, 1, 0)).get();
-                if (neighborChunk)
-                {
-                    for (int x = 0; x < CHUNK_SIZE; ++x)
-                    {
-                        for (int z = 0; z < CHUNK_SIZE; ++z)
-                        {
-                            int neighborLightLevel = neighborChunk->GetSkyLightLevel(x, 0, z);
-                            if (neighborLightLevel > 0)
-                            {
-                                skyLightQueue.emplace(x, 0, z, neighborChunk);
-                            }
-                        }
-                    }
-                }
-            }
-            // Negative Y
-            {
-                ChunkData* neighborChunk = chunkManager->GetChunkData(chunkData->id + glm::ivec3(0, -1, 0)).get();
-                if (neighborChunk)
-                {
-                    for (int x = 0; x < CHUNK_SIZE; ++x)
-                    {
-                        for (int z = 0; z < CHUNK_SIZE; ++z)
-                        {
-                            int neighborLightLevel = neighborChunk->GetSkyLightLevel(x, CHUNK_SIZE - 1, z);
-                            if (neighborLightLevel > 1)
-                            {
-                                skyLightQueue.emplace(x, CHUNK_SIZE - 1, z, neighborChunk);
-                            }
-                        }
-                    }
-                }
-            }
-            // Positive X
-            {
-                ChunkData* neighborChunk = chunkManager->GetChunkData(chunkData->id + glm::ivec3(1, 0, 0)).get();
-                if (neighborChunk)
-                {
-                    for (int y = 0; y < CHUNK_SIZE; ++y)
-                    {
-                        for (int z = 0; z < CHUNK_SIZE; ++z)
-                        {
-                            int neighborLightLevel = neighborChunk->GetSkyLightLevel(0, y, z);
-                            if (neighborLightLevel > 1)
-                            {
-                                skyLightQueue.emplace(0, y, z, neighborChunk);
-                            }
-                        }
-                    }
-                }
-            }
-            // Negative X
-            {
-                ChunkData* neighborChunk = chunkManager->GetChunkData(chunkData->id + glm::ivec3(-1, 0, 0)).get();
-                if (neighborChunk)
-                {
-                    for (int y = 0; y < CHUNK_SIZE; ++y)
-                    {
-                        for (int z = 0; z < CHUNK_SIZE; ++z)
-                        {
-                            int neighborLightLevel = neighborChunk->GetSkyLightLevel(CHUNK_SIZE - 1, y, z);
-                            if (neighborLightLevel > 1)
-                            {
-                                skyLightQueue.emplace(CHUNK_SIZE - 1, y, z, neighborChunk);
-                            }
-                        }
-                    }
-                }
-            }
-            // Positive Z
-            {
-                ChunkData* neighborChunk = chunkManager->GetChunkData(chunkData->id + glm::ivec3(0, 0, 1)).get();
-                if (neighborChunk)
-                {
-                    for (int x = 0; x < CHUNK_SIZE; ++x)
-                    {
-                        for (int y = 0; y < CHUNK_SIZE; ++y)
-                        {
-                            int neighborLightLevel = neighborChunk->GetSkyLightLevel(x, y, 0);
-                            if (neighborLightLevel > 1)
-                            {
-                                skyLightQueue.emplace(x, y, 0, neighborChunk);
-                            }
-                        }
-                    }
-                }
-            }
-            // Negative Z
-            {
-                ChunkData* neighborChunk = chunkManager->GetChunkData(chunkData->id + glm::ivec3(0, 0, -1)).get();
-                if (neighborChunk)
-                {
-                    for (int x = 0; x < CHUNK_SIZE; ++x)
-                    {
-                        for (int y = 0; y < CHUNK_SIZE; ++y)
-                        {
-                            int neighborLightLevel = neighborChunk->GetSkyLightLevel(x, y, CHUNK_SIZE - 1);
-                            if (neighborLightLevel > 1)
-                            {
-                                skyLightQueue.emplace(x, y, CHUNK_SIZE - 1, neighborChunk);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        // Propagate sky light
-        std::unordered_set<glm::ivec3> chunksToRemesh;
-        PropagateSkyLight(chunkManager, skyLightQueue, chunksToRemesh);
-        chunksToRemesh.insert(chunkData->id);
-        return chunksToRemesh;
-    }
-
-    std::unordered_set<glm::ivec3> AddSkyLightBlocker(ChunkManager* chunkManager, ChunkData* chunkData, int x, int y, int z)
+    inline void PropagateSkyLightRemoval(ChunkManager* chunkManager, std::queue<LightRemovalNode>& lightRemovalQueue, std::queue<LightNode>& lightPropagationQueue, std::unordered_set<glm::ivec3>& chunksToRemesh)
     {
-        // Initialize remesh vector
-        std::unordered_set<glm::ivec3> chunksToRemesh;
-        chunksToRemesh.insert(chunkData->id);
-
-        // Initialize BFS
-        std::queue<LightRemovalNode> lightRemovalQueue;
-        std::queue<LightNode> lightPropagationQueue;
-
-        // Set initial light level and enqueue
-        int lightLevel = chunkData->GetSkyLightLevel(x, y, z);
-        lightRemovalQueue.emplace(x, y, z, chunkData, lightLevel);
-
-        chunkData->SetSkyLightLevel(x, y, z, 0);
-
-        // BFS for light removal
         while (!lightRemovalQueue.empty())
         {
             // Get node from queue
@@ -700,50 +615,10 @@ namespace WillowVox::VoxelLighting
                 }
             }
         }
-        
-        // Propagate re-added light emitters
-        PropagateSkyLight(chunkManager, lightPropagationQueue, chunksToRemesh);
-
-        return chunksToRemesh;
-    }
-
-    std::unordered_set<glm::ivec3> RemoveSkyLightBlocker(ChunkManager* chunkManager, ChunkData* chunkData, int x, int y, int z)
-    {
-        // Get highest sky light level from neighbors
-        int skyLightLevel = 0;
-        int skyLightX, skyLightY, skyLightZ;
-        ChunkData* skyLightChunk = chunkData;
-        GetHighestSkyLightNeighbor(chunkManager, chunkData, x, y, z, skyLightLevel, skyLightChunk, skyLightX, skyLightY, skyLightZ);
-
-        // If no neighbors have sky light, return
-        if (skyLightLevel == 0)
-            return {};
-
-        // Propagate sky light
-        std::unordered_set<glm::ivec3> chunksToRemesh;
-        chunksToRemesh.insert(chunkData->id);
-        std::queue<LightNode> sunlightQueue;
-
-        sunlightQueue.emplace(skyLightX, skyLightY, skyLightZ, skyLightChunk);
-        PropagateSkyLight(chunkManager, sunlightQueue, chunksToRemesh);
-
-        return chunksToRemesh;
     }
 
-    std::unordered_set<glm::ivec3> AddLightEmitter(ChunkManager* chunkManager, ChunkData* chunkData, int x, int y, int z, int lightLevel)
+    inline void PropagateLight(ChunkManager* chunkManager, std::queue<LightNode>& lightQueue, std::unordered_set<glm::ivec3>& chunksToRemesh)
     {
-        // Initialize remesh vector
-        std::unordered_set<glm::ivec3> chunksToRemesh;
-        chunksToRemesh.insert(chunkData->id);
-
-        // Initialize BFS
-        std::queue<LightNode> lightQueue;
-
-        // Set initial light level and enqueue
-        chunkData->SetLightLevel(x, y, z, lightLevel);
-        lightQueue.emplace(x, y, z, chunkData);
-
-        // BFS for light propagation
         while (!lightQueue.empty())
         {
             // Get node from queue
@@ -921,27 +796,10 @@ namespace WillowVox::VoxelLighting
                 }
             }
         }
-
-        return chunksToRemesh;
     }
 
-    std::unordered_set<glm::ivec3> RemoveLightEmitter(ChunkManager* chunkManager, ChunkData* chunkData, int x, int y, int z)
+    inline void PropagateLightRemoval(ChunkManager* chunkManager, std::queue<LightRemovalNode>& lightRemovalQueue, std::queue<LightNode>& lightPropagationQueue, std::unordered_set<glm::ivec3>& chunksToRemesh)
     {
-        // Initialize remesh vector
-        std::unordered_set<glm::ivec3> chunksToRemesh;
-        chunksToRemesh.insert(chunkData->id);
-
-        // Initialize BFS
-        std::queue<LightRemovalNode> lightRemovalQueue;
-        std::queue<LightNode> lightPropagationQueue;
-
-        // Set initial light level and enqueue
-        int lightLevel = chunkData->GetLightLevel(x, y, z);
-        lightRemovalQueue.emplace(x, y, z, chunkData, lightLevel);
-
-        chunkData->SetLightLevel(x, y, z, 0);
-
-        // BFS for light removal
         while (!lightRemovalQueue.empty())
         {
             // Get node from queue
@@ -1121,23 +979,248 @@ namespace WillowVox::VoxelLighting
                 }
             }
         }
-
-        // Re-add light from neighbors
-        while (!lightPropagationQueue.empty())
-        {
-            LightNode& node = lightPropagationQueue.front();
-            int x = node.x;
-            int y = node.y;
-            int z = node.z;
-            ChunkData* currentChunk = node.chunk;
-            lightPropagationQueue.pop();
-
-            int lightLevel = currentChunk->GetLightLevel(x, y, z);
-            auto newChunks = AddLightEmitter(chunkManager, currentChunk, x, y, z, lightLevel);
-            chunksToRemesh.insert(newChunks.begin(), newChunks.end());
-        }
-
-        return chunksToRemesh;
+    }
+
+    std::unordered_set<glm::ivec3> CalculateFullLighting(ChunkManager* chunkManager, ChunkData* chunkData)
+    {
+        chunkData->ClearLight();
+
+        // Create lighting queues
+        std::queue<LightNode> skyLightQueue;
+
+        // If empty and above 0, start sky lighting
+        if (chunkData->IsEmpty() && chunkData->id.y > 0)
+        {
+            // Sky light passes straight down through an empty chunk, so every voxel ends up at the
+            // maximum level. Fill it uniformly and only propagate from the border into neighbors.
+            chunkData->FillLight(0, MAX_LIGHT_LEVEL);
+            for (int x = 0; x < CHUNK_SIZE; ++x)
+            {
+                for (int z = 0; z < CHUNK_SIZE; ++z)
+                {
+                    if (x == 0 || x == CHUNK_SIZE - 1 || z == 0 || z == CHUNK_SIZE - 1)
+                    {
+                        for (int y = 0; y < CHUNK_SIZE; ++y)
+                            skyLightQueue.emplace(x, y, z, chunkData);
+                    }
+                    else
+                    {
+                        skyLightQueue.emplace(x, 0, z, chunkData);
+                        skyLightQueue.emplace(x, CHUNK_SIZE - 1, z, chunkData);
+                    }
+                }
+            }
+        }
+        else
+        {
+            // Add edges of neighbors to sky light queue
+            // Positive Y
+            {
+                ChunkData* neighborChunk = chunkManager->GetChunkData(chunkData->id + glm::ivec3(0, 1, 0)).get();
+                if (neighborChunk)
+                {
+                    for (int x = 0; x < CHUNK_SIZE; ++x)
+                    {
+                        for (int z = 0; z < CHUNK_SIZE; ++z)
+                        {
+                            int neighborLightLevel = neighborChunk->GetSkyLightLevel(x, 0, z);
+                            if (neighborLightLevel > 0)
+                            {
+                                skyLightQueue.emplace(x, 0, z, neighborChunk);
+                            }
+                        }
+                    }
+                }
+            }
+            // Negative Y
+            {
+                ChunkData* neighborChunk = chunkManager->GetChunkData(chunkData->id + glm::ivec3(0, -1, 0)).get();
+                if (neighborChunk)
+                {
+                    for (int x = 0; x < CHUNK_SIZE; ++x)
+                    {
+                        for (int z = 0; z < CHUNK_SIZE; ++z)
+                        {
+                            int neighborLightLevel = neighborChunk->GetSkyLightLevel(x, CHUNK_SIZE - 1, z);
+                            if (neighborLightLevel > 1)
+                            {
+                                skyLightQueue.emplace(x, CHUNK_SIZE - 1, z, neighborChunk);
+                            }
+                        }
+                    }
+                }
+            }
+            // Positive X
+            {
+                ChunkData* neighborChunk = chunkManager->GetChunkData(chunkData->id + glm::ivec3(1, 0, 0)).get();
+                if (neighborChunk)
+                {
+                    for (int y = 0; y < CHUNK_SIZE; ++y)
+                    {
+                        for (int z = 0; z < CHUNK_SIZE; ++z)
+                        {
+                            int neighborLightLevel = neighborChunk->GetSkyLightLevel(0, y, z);
+                            if (neighborLightLevel > 1)
+                            {
+                                skyLightQueue.emplace(0, y, z, neighborChunk);
+                            }
+                        }
+                    }
+                }
+            }
+            // Negative X
+            {
+                ChunkData* neighborChunk = chunkManager->GetChunkData(chunkData->id + glm::ivec3(-1, 0, 0)).get();
+                if (neighborChunk)
+                {
+                    for (int y = 0; y < CHUNK_SIZE; ++y)
+                    {
+                        for (int z = 0; z < CHUNK_SIZE; ++z)
+                        {
+                            int neighborLightLevel = neighborChunk->GetSkyLightLevel(CHUNK_SIZE - 1, y, z);
+                            if (neighborLightLevel > 1)
+                            {
+                                skyLightQueue.emplace(CHUNK_SIZE - 1, y, z, neighborChunk);
+                            }
+                        }
+                    }
+                }
+            }
+            // Positive Z
+            {
+                ChunkData* neighborChunk = chunkManager->GetChunkData(chunkData->id + glm::ivec3(0, 0, 1)).get();
+                if (neighborChunk)
+                {
+                    for (int x = 0; x < CHUNK_SIZE; ++x)
+                    {
+                        for (int y = 0; y < CHUNK_SIZE; ++y)
+                        {
+                            int neighborLightLevel = neighborChunk->GetSkyLightLevel(x, y, 0);
+                            if (neighborLightLevel > 1)
+                            {
+                                skyLightQueue.emplace(x, y, 0, neighborChunk);
+                            }
+                        }
+                    }
+                }
+            }
+            // Negative Z
+            {
+                ChunkData* neighborChunk = chunkManager->GetChunkData(chunkData->id + glm::ivec3(0, 0, -1)).get();
+                if (neighborChunk)
+                {
+                    for (int x = 0; x < CHUNK_SIZE; ++x)
+                    {
+                        for (int y = 0; y < CHUNK_SIZE; ++y)
+                        {
+                            int neighborLightLevel = neighborChunk->GetSkyLightLevel(x, y, CHUNK_SIZE - 1);
+                            if (neighborLightLevel > 1)
+                            {
+                                skyLightQueue.emplace(x, y, CHUNK_SIZE - 1, neighborChunk);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // Propagate sky light
+        std::unordered_set<glm::ivec3> chunksToRemesh;
+        PropagateSkyLight(chunkManager, skyLightQueue, chunksToRemesh);
+        chunksToRemesh.insert(chunkData->id);
+        return chunksToRemesh;
+    }
+
+    std::unordered_set<glm::ivec3> AddSkyLightBlocker(ChunkManager* chunkManager, ChunkData* chunkData, int x, int y, int z)
+    {
+        // Initialize remesh vector
+        std::unordered_set<glm::ivec3> chunksToRemesh;
+        chunksToRemesh.insert(chunkData->id);
+
+        // Initialize BFS
+        std::queue<LightRemovalNode> lightRemovalQueue;
+        std::queue<LightNode> lightPropagationQueue;
+
+        // Set initial light level and enqueue
+        int lightLevel = chunkData->GetSkyLightLevel(x, y, z);
+        lightRemovalQueue.emplace(x, y, z, chunkData, lightLevel);
+
+        chunkData->SetSkyLightLevel(x, y, z, 0);
+
+        // BFS for light removal
+        PropagateSkyLightRemoval(chunkManager, lightRemovalQueue, lightPropagationQueue, chunksToRemesh);
+        
+        // Propagate re-added light emitters
+        PropagateSkyLight(chunkManager, lightPropagationQueue, chunksToRemesh);
+
+        return chunksToRemesh;
+    }
+
+    std::unordered_set<glm::ivec3> RemoveSkyLightBlocker(ChunkManager* chunkManager, ChunkData* chunkData, int x, int y, int z)
+    {
+        // Get highest sky light level from neighbors
+        int skyLightLevel = 0;
+        int skyLightX, skyLightY, skyLightZ;
+        ChunkData* skyLightChunk = chunkData;
+        GetHighestSkyLightNeighbor(chunkManager, chunkData, x, y, z, skyLightLevel, skyLightChunk, skyLightX, skyLightY, skyLightZ);
+
+        // If no neighbors have sky light, return
+        if (skyLightLevel == 0)
+            return {};
+
+        // Propagate sky light
+        std::unordered_set<glm::ivec3> chunksToRemesh;
+        chunksToRemesh.insert(chunkData->id);
+        std::queue<LightNode> sunlightQueue;
+
+        sunlightQueue.emplace(skyLightX, skyLightY, skyLightZ, skyLightChunk);
+        PropagateSkyLight(chunkManager, sunlightQueue, chunksToRemesh);
+
+        return chunksToRemesh;
+    }
+
+    std::unordered_set<glm::ivec3> AddLightEmitter(ChunkManager* chunkManager, ChunkData* chunkData, int x, int y, int z, int lightLevel)
+    {
+        // Initialize remesh vector
+        std::unordered_set<glm::ivec3> chunksToRemesh;
+        chunksToRemesh.insert(chunkData->id);
+
+        // Initialize BFS
+        std::queue<LightNode> lightQueue;
+
+        // Set initial light level and enqueue
+        chunkData->SetLightLevel(x, y, z, lightLevel);
+        lightQueue.emplace(x, y, z, chunkData);
+
+        // BFS for light propagation
+        PropagateLight(chunkManager, lightQueue, chunksToRemesh);
+
+        return chunksToRemesh;
+    }
+
+    std::unordered_set<glm::ivec3> RemoveLightEmitter(ChunkManager* chunkManager, ChunkData* chunkData, int x, int y, int z)
+    {
+        // Initialize remesh vector
+        std::unordered_set<glm::ivec3> chunksToRemesh;
+        chunksToRemesh.insert(chunkData->id);
+
+        // Initialize BFS
+        std::queue<LightRemovalNode> lightRemovalQueue;
+        std::queue<LightNode> lightPropagationQueue;
+
+        // Set initial light level and enqueue
+        int lightLevel = chunkData->GetLightLevel(x, y, z);
+        lightRemovalQueue.emplace(x, y, z, chunkData, lightLevel);
+
+        chunkData->SetLightLevel(x, y, z, 0);
+
+        // BFS for light removal
+        PropagateLightRemoval(chunkManager, lightRemovalQueue, lightPropagationQueue, chunksToRemesh);
+
+        // Re-add light from neighbors
+        PropagateLight(chunkManager, lightPropagationQueue, chunksToRemesh);
+
+        return chunksToRemesh;
     }
 
     std::unordered_set<glm::ivec3> AddLightBlocker(ChunkManager* chunkManager, ChunkData* chunkData, int x, int y, int z)
@@ -1317,4 +1400,83 @@ namespace WillowVox::VoxelLighting
         // Add light from the strongest neighbor
         return AddLightEmitter(chunkManager, maxLightChunk, maxLightX, maxLightY, maxLightZ, maxLightLevel);
     }
+
+    std::unordered_set<glm::ivec3> UpdateLighting(ChunkManager* chunkManager, const std::vector<LightChange>& changes)
+    {
+        static const glm::ivec3 neighborOffsets[6] = {
+            { 0, 0, 1 }, { 0, 0, -1 }, { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }
+        };
+
+        // Initialize remesh vector
+        std::unordered_set<glm::ivec3> chunksToRemesh;
+
+        // Initialize BFS
+        std::queue<LightRemovalNode> lightRemovalQueue;
+        std::queue<LightRemovalNode> skyLightRemovalQueue;
+        std::queue<LightNode> lightQueue;
+        std::queue<LightNode> skyLightQueue;
+
+        // Clear the light of every changed voxel first, so all removals spread in a single BFS
+        for (auto& change : changes)
+        {
+            ChunkData* chunkData = change.chunkData;
+            chunksToRemesh.insert(chunkData->id);
+
+            int lightLevel = chunkData->GetLightLevel(change.x, change.y, change.z);
+            if (lightLevel > 0)
+            {
+                chunkData->SetLightLevel(change.x, change.y, change.z, 0);
+                lightRemovalQueue.emplace(change.x, change.y, change.z, chunkData, lightLevel);
+            }
+
+            // Only solid blocks stop sky light
+            int skyLightLevel = chunkData->GetSkyLightLevel(change.x, change.y, change.z);
+            if (skyLightLevel > 0 && chunkData->Get(change.x, change.y, change.z) != 0)
+            {
+                chunkData->SetSkyLightLevel(change.x, change.y, change.z, 0);
+                skyLightRemovalQueue.emplace(change.x, change.y, change.z, chunkData, skyLightLevel);
+            }
+        }
+
+        PropagateLightRemoval(chunkManager, lightRemovalQueue, lightQueue, chunksToRemesh);
+        PropagateSkyLightRemoval(chunkManager, skyLightRemovalQueue, skyLightQueue, chunksToRemesh);
+
+        // Add new emitters and let the light of neighbors flow into voxels that became air
+        for (auto& change : changes)
+        {
+            ChunkData* chunkData = change.chunkData;
+            if (change.lightLevel > 0)
+            {
+                chunkData->SetLightLevel(change.x, change.y, change.z, change.lightLevel);
+                lightQueue.emplace(change.x, change.y, change.z, chunkData);
+                continue;
+            }
+
+            if (chunkData->Get(change.x, change.y, change.z) != 0)
+                continue;
+
+            for (auto& offset : neighborOffsets)
+            {
+                glm::ivec3 pos = glm::ivec3(change.x, change.y, change.z) + offset;
+                ChunkData* targetChunk = chunkData;
+                if (!chunkData->InBounds(pos.x, pos.y, pos.z))
+                {
+                    targetChunk = chunkManager->GetChunkData(chunkData->id + offset).get();
+                    pos -= offset * CHUNK_SIZE;
+                }
+                if (!targetChunk)
+                    continue;
+
+                if (targetChunk->GetLightLevel(pos.x, pos.y, pos.z) > 0)
+                    lightQueue.emplace(pos.x, pos.y, pos.z, targetChunk);
+                if (targetChunk->GetSkyLightLevel(pos.x, pos.y, pos.z) > 0)
+                    skyLightQueue.emplace(pos.x, pos.y, pos.z, targetChunk);
+            }
+        }
+
+        PropagateLight(chunkManager, lightQueue, chunksToRemesh);
+        PropagateSkyLight(chunkManager, skyLightQueue, chunksToRemesh);
+
+        return chunksToRemesh;
+    }
 }
\ No newline at end of file
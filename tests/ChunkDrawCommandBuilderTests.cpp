@@ -0,0 +1,70 @@
+#include <wv/voxel_worlds/ChunkDrawCommandBuilder.h>
+#include "TestHelpers.h"
+
+using namespace WillowVox;
+
+static void TestCommands()
+{
+    ChunkDrawCommandBuilder builder;
+    WV_CHECK(builder.Empty());
+
+    builder.AddChunk({ 1, 2, 3 }, 400, 10);
+    builder.AddChunk({ -1, 0, 5 }, 0, 25);
+    // Empty meshes get no draw and no chunk offset
+    builder.AddChunk({ 7, 7, 7 }, 1000, 0);
+    builder.AddChunk({ 0, -2, 0 }, 1200, 3);
+
+    auto& commands = builder.GetCommands();
+    auto& offsets = builder.GetChunkOffsets();
+    WV_CHECK_EQ(commands.size(), 3u);
+    WV_CHECK_EQ(offsets.size(), 3u);
+    if (commands.size() != 3 || offsets.size() != 3)
+        return;
+
+    // Six indices per quad, one instance, all starting from the shared quad index pattern
+    WV_CHECK_EQ(commands[0].count, 60u);
+    WV_CHECK_EQ(commands[1].count, 150u);
+    WV_CHECK_EQ(commands[2].count, 18u);
+    for (auto& command : commands)
+    {
+        WV_CHECK_EQ(command.instanceCount, 1u);
+        WV_CHECK_EQ(command.firstIndex, 0u);
+    }
+
+    // baseVertex points at the mesh in the arena
+    WV_CHECK_EQ(commands[0].baseVertex, 400);
+    WV_CHECK_EQ(commands[1].baseVertex, 0);
+    WV_CHECK_EQ(commands[2].baseVertex, 1200);
+
+    // baseInstance indexes the chunk offsets, skipped chunks leave no gap
+    WV_CHECK_EQ(commands[0].baseInstance, 0u);
+    WV_CHECK_EQ(commands[1].baseInstance, 1u);
+    WV_CHECK_EQ(commands[2].baseInstance, 2u);
+    WV_CHECK(offsets[0] == glm::vec3(1, 2, 3) * (float)CHUNK_SIZE);
+    WV_CHECK(offsets[1] == glm::vec3(-1, 0, 5) * (float)CHUNK_SIZE);
+    WV_CHECK(offsets[2] == glm::vec3(0, -2, 0) * (float)CHUNK_SIZE);
+
+    WV_CHECK_EQ(builder.GetMaxQuadCount(), 25u);
+}
+
+static void TestClear()
+{
+    ChunkDrawCommandBuilder builder;
+    builder.AddChunk({ 0, 0, 0 }, 0, 8);
+    builder.Clear();
+    WV_CHECK(builder.Empty());
+    WV_CHECK_EQ(builder.GetChunkOffsets().size(), 0u);
+    WV_CHECK_EQ(builder.GetMaxQuadCount(), 0u);
+
+    // Instances start from 0 again
+    builder.AddChunk({ 0, 0, 0 }, 64, 2);
+    WV_CHECK_EQ(builder.GetCommands()[0].baseInstance, 0u);
+    WV_CHECK_EQ(builder.GetMaxQuadCount(), 2u);
+}
+
+int main()
+{
+    TestCommands();
+    TestClear();
+    return WillowVox::Tests::Finish();
+}
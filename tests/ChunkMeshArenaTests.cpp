@@ -0,0 +1,108 @@
+#include <wv/voxel_worlds/ChunkMeshArena.h>
+#include "TestHelpers.h"
+
+using namespace WillowVox;
+
+static void TestFirstFit()
+{
+    ChunkMeshArena arena(100);
+    uint32_t a, b, c;
+    WV_CHECK(arena.Allocate(10, a));
+    WV_CHECK(arena.Allocate(20, b));
+    WV_CHECK(arena.Allocate(30, c));
+    WV_CHECK_EQ(a, 0u);
+    WV_CHECK_EQ(b, 10u);
+    WV_CHECK_EQ(c, 30u);
+    WV_CHECK_EQ(arena.GetUsed(), 60u);
+
+    // Free a hole in the middle, a small allocation goes into the first range that fits
+    arena.Free(b, 20);
+    uint32_t d;
+    WV_CHECK(arena.Allocate(5, d));
+    WV_CHECK_EQ(d, 10u);
+
+    // Too large for the rest of the hole, so it comes from the tail
+    uint32_t e;
+    WV_CHECK(arena.Allocate(16, e));
+    WV_CHECK_EQ(e, 60u);
+
+    // Fits the rest of the hole exactly
+    uint32_t f;
+    WV_CHECK(arena.Allocate(15, f));
+    WV_CHECK_EQ(f, 15u);
+    WV_CHECK_EQ(arena.GetFreeRangeCount(), 1u);
+    WV_CHECK_EQ(arena.GetUsed(), 76u);
+
+    // Empty allocations are refused
+    uint32_t g;
+    WV_CHECK(!arena.Allocate(0, g));
+}
+
+static void TestFreeMergesNeighbors()
+{
+    ChunkMeshArena arena(40);
+    uint32_t a, b, c, d;
+    arena.Allocate(10, a);
+    arena.Allocate(10, b);
+    arena.Allocate(10, c);
+    arena.Allocate(10, d);
+    WV_CHECK_EQ(arena.GetFreeRangeCount(), 0u);
+
+    // Separate ranges while not touching
+    arena.Free(a, 10);
+    arena.Free(c, 10);
+    WV_CHECK_EQ(arena.GetFreeRangeCount(), 2u);
+    WV_CHECK_EQ(arena.GetLargestFreeRange(), 10u);
+
+    // Merges with the range before and the range after
+    arena.Free(b, 10);
+    WV_CHECK_EQ(arena.GetFreeRangeCount(), 1u);
+    WV_CHECK_EQ(arena.GetLargestFreeRange(), 30u);
+
+    // Merges with the range before only
+    arena.Free(d, 10);
+    WV_CHECK_EQ(arena.GetFreeRangeCount(), 1u);
+    WV_CHECK_EQ(arena.GetLargestFreeRange(), 40u);
+    WV_CHECK_EQ(arena.GetUsed(), 0u);
+
+    // Merges with the range after only
+    uint32_t all, tail;
+    arena.Allocate(40, all);
+    arena.Free(20, 20);
+    arena.Allocate(20, tail);
+    WV_CHECK_EQ(tail, 20u);
+    arena.Free(10, 10);
+    arena.Free(20, 20);
+    WV_CHECK_EQ(arena.GetFreeRangeCount(), 1u);
+    WV_CHECK_EQ(arena.GetLargestFreeRange(), 30u);
+}
+
+static void TestFullThenGrow()
+{
+    ChunkMeshArena arena(32);
+    uint32_t a, b;
+    WV_CHECK(arena.Allocate(24, a));
+    WV_CHECK(!arena.Allocate(16, b));
+    WV_CHECK_EQ(arena.GetUsed(), 24u);
+
+    // Growing never shrinks and keeps existing offsets
+    arena.Grow(16);
+    WV_CHECK_EQ(arena.GetCapacity(), 32u);
+    arena.Grow(64);
+    WV_CHECK_EQ(arena.GetCapacity(), 64u);
+
+    // The new space merges with the free tail of the old capacity
+    WV_CHECK_EQ(arena.GetFreeRangeCount(), 1u);
+    WV_CHECK_EQ(arena.GetLargestFreeRange(), 40u);
+    WV_CHECK(arena.Allocate(16, b));
+    WV_CHECK_EQ(b, 24u);
+    WV_CHECK_EQ(arena.GetUsed(), 40u);
+}
+
+int main()
+{
+    TestFirstFit();
+    TestFreeMergesNeighbors();
+    TestFullThenGrow();
+    return WillowVox::Tests::Finish();
+}
@@ -0,0 +1,179 @@
+#include <wv/voxel_worlds/ChunkSerializer.h>
+#include "TestHelpers.h"
+#include <memory>
+#include <random>
+
+using namespace WillowVox;
+
+// Stone and dirt under air with a few ores, lit from above
+static std::unique_ptr<ChunkData> MakeTerrainChunk()
+{
+    auto chunk = std::make_unique<ChunkData>(glm::ivec3(3, -1, -7));
+    std::mt19937 random(7);
+    for (int z = 0; z < CHUNK_SIZE; z++)
+    {
+        for (int x = 0; x < CHUNK_SIZE; x++)
+        {
+            int height = 12 + (x * 3 + z * 5) % 9;
+            for (int y = 0; y < CHUNK_SIZE; y++)
+            {
+                BlockId block = y < height - 3 ? 1 : y < height ? 2 : 0;
+                if (block == 1 && random() % 50 == 0)
+                    block = 1000 + random() % 3;
+                chunk->Set(x, y, z, block);
+                chunk->SetSkyLightLevel(x, y, z, y >= height ? MAX_LIGHT_LEVEL : 0);
+                chunk->SetLightLevel(x, y, z, (x + y + z) % 4 == 0 ? 7 : 0);
+            }
+        }
+    }
+    return chunk;
+}
+
+static bool SameBlocks(const ChunkData& a, const ChunkData& b)
+{
+    for (int z = 0; z < CHUNK_SIZE; z++)
+        for (int x = 0; x < CHUNK_SIZE; x++)
+            for (int y = 0; y < CHUNK_SIZE; y++)
+                if (a.Get(x, y, z) != b.Get(x, y, z))
+                    return false;
+    return a.GetSolidCount() == b.GetSolidCount();
+}
+
+static bool SameLight(const ChunkData& a, const ChunkData& b)
+{
+    for (int z = 0; z < CHUNK_SIZE; z++)
+        for (int x = 0; x < CHUNK_SIZE; x++)
+            for (int y = 0; y < CHUNK_SIZE; y++)
+                if (a.GetPackedLight(x, y, z) != b.GetPackedLight(x, y, z))
+                    return false;
+    return true;
+}
+
+static void TestRoundTrip()
+{
+    auto chunk = MakeTerrainChunk();
+    const uint8_t flagSets[] = { 0, ChunkSerializer::INCLUDE_LIGHT, ChunkSerializer::COMPRESS,
+        ChunkSerializer::INCLUDE_LIGHT | ChunkSerializer::COMPRESS };
+    for (uint8_t flags : flagSets)
+    {
+        std::vector<uint8_t> data;
+        ChunkSerializer::Serialize(*chunk, data, flags);
+
+        glm::ivec3 id;
+        WV_CHECK(ChunkSerializer::GetChunkId(data.data(), data.size(), id));
+        WV_CHECK(id == chunk->id);
+
+        ChunkData decoded({ 0, 0, 0 });
+        WV_CHECK(ChunkSerializer::Deserialize(data.data(), data.size(), decoded));
+        WV_CHECK(SameBlocks(*chunk, decoded));
+        if (flags & ChunkSerializer::INCLUDE_LIGHT)
+            WV_CHECK(SameLight(*chunk, decoded));
+        // The id isn't touched by decoding
+        WV_CHECK(decoded.id == glm::ivec3(0, 0, 0));
+    }
+
+    // Appends after what is already in the buffer
+    std::vector<uint8_t> data = { 9, 9, 9 };
+    ChunkSerializer::Serialize(*chunk, data);
+    ChunkData decoded({ 0, 0, 0 });
+    WV_CHECK(ChunkSerializer::Deserialize(data.data() + 3, data.size() - 3, decoded));
+    WV_CHECK(SameBlocks(*chunk, decoded));
+}
+
+static void TestUniformChunks()
+{
+    // An empty chunk is one run of air
+    ChunkData empty({ 1, 2, 3 });
+    std::vector<uint8_t> data;
+    ChunkSerializer::Serialize(empty, data);
+    ChunkData decoded({ 0, 0, 0 });
+    decoded.Set(4, 4, 4, 5);
+    WV_CHECK(ChunkSerializer::Deserialize(data.data(), data.size(), decoded));
+    WV_CHECK(decoded.IsEmpty());
+    WV_CHECK(decoded.IsLightUniform());
+    WV_CHECK(SameBlocks(empty, decoded));
+
+    // A full chunk stays a single uniform block
+    ChunkData full({ 0, 0, 0 });
+    full.FillBlocks(3);
+    full.FillLight(0, MAX_LIGHT_LEVEL);
+    data.clear();
+    ChunkSerializer::Serialize(full, data);
+    WV_CHECK(data.size() < ChunkSerializer::HEADER_SIZE + 16);
+    WV_CHECK(ChunkSerializer::Deserialize(data.data(), data.size(), decoded));
+    WV_CHECK_EQ(decoded.GetSolidCount(), CHUNK_VOLUME);
+    WV_CHECK(SameBlocks(full, decoded));
+    WV_CHECK(SameLight(full, decoded));
+}
+
+static void TestMalformed()
+{
+    auto chunk = MakeTerrainChunk();
+    for (uint8_t flags : { (uint8_t)ChunkSerializer::INCLUDE_LIGHT, (uint8_t)(ChunkSerializer::INCLUDE_LIGHT | ChunkSerializer::COMPRESS) })
+    {
+        std::vector<uint8_t> data;
+        ChunkSerializer::Serialize(*chunk, data, flags);
+        ChunkData decoded({ 0, 0, 0 });
+
+        // Every truncation is rejected and leaves the chunk empty
+        for (size_t size = 0; size < data.size(); size += size < 64 ? 1 : 7)
+        {
+            decoded.Set(0, 0, 0, 1);
+            WV_CHECK(!ChunkSerializer::Deserialize(data.data(), size, decoded));
+            WV_CHECK(decoded.IsEmpty());
+        }
+
+        // Trailing bytes after the body
+        std::vector<uint8_t> longer = data;
+        longer.push_back(0);
+        WV_CHECK(!ChunkSerializer::Deserialize(longer.data(), longer.size(), decoded));
+
+        // Bad magic, a newer version and a body size that doesn't match
+        std::vector<uint8_t> corrupt = data;
+        corrupt[0] ^= 0xFF;
+        WV_CHECK(!ChunkSerializer::Deserialize(corrupt.data(), corrupt.size(), decoded));
+        glm::ivec3 id;
+        WV_CHECK(!ChunkSerializer::GetChunkId(corrupt.data(), corrupt.size(), id));
+        corrupt = data;
+        corrupt[4] = ChunkSerializer::VERSION + 1;
+        WV_CHECK(!ChunkSerializer::Deserialize(corrupt.data(), corrupt.size(), decoded));
+        corrupt = data;
+        corrupt[20] ^= 0x01;
+        WV_CHECK(!ChunkSerializer::Deserialize(corrupt.data(), corrupt.size(), decoded));
+        corrupt = data;
+        corrupt[23] = 0xFF;
+        WV_CHECK(!ChunkSerializer::Deserialize(corrupt.data(), corrupt.size(), decoded));
+
+        // Flipped body bytes are either rejected or decode to some valid chunk, never out of bounds
+        std::mt19937 random(5);
+        for (int i = 0; i < 200; i++)
+        {
+            corrupt = data;
+            size_t index = ChunkSerializer::HEADER_SIZE + random() % (data.size() - ChunkSerializer::HEADER_SIZE);
+            corrupt[index] ^= (uint8_t)(1 + random() % 255);
+            if (!ChunkSerializer::Deserialize(corrupt.data(), corrupt.size(), decoded))
+                WV_CHECK(decoded.IsEmpty());
+        }
+    }
+
+    // A palette index past the end of the palette: 1 palette entry, then a run using index 1
+    std::vector<uint8_t> data;
+    ChunkData empty({ 0, 0, 0 });
+    ChunkSerializer::Serialize(empty, data, 0);
+    std::vector<uint8_t> badIndex(data.begin(), data.begin() + ChunkSerializer::HEADER_SIZE);
+    const uint8_t body[] = { 1, 0, 0x80, 0x80, 0x02, 1 };
+    badIndex.insert(badIndex.end(), body, body + sizeof(body));
+    badIndex[20] = sizeof(body);
+    ChunkData decoded({ 0, 0, 0 });
+    WV_CHECK(!ChunkSerializer::Deserialize(badIndex.data(), badIndex.size(), decoded));
+    badIndex.back() = 0;
+    WV_CHECK(ChunkSerializer::Deserialize(badIndex.data(), badIndex.size(), decoded));
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestUniformChunks();
+    TestMalformed();
+    return WillowVox::Tests::Finish();
+}
@@ -0,0 +1,212 @@
+#include <wv/voxel_worlds/ChunkUploadQueue.h>
+#include "TestHelpers.h"
+
+using namespace WillowVox;
+
+// Any distinct addresses work as keys
+static const int s_keys[8] = {};
+static ChunkUploadQueue::Key Key(int i) { return &s_keys[i]; }
+
+static bool AlwaysSignalled(uint64_t) { return true; }
+
+static void TestBudgetCutoff()
+{
+    ChunkUploadQueue queue(100, 2);
+    queue.Enqueue(Key(0), 40);
+    queue.Enqueue(Key(1), 50);
+    queue.Enqueue(Key(2), 20);
+    WV_CHECK_EQ(queue.GetQueuedBytes(), 110u);
+    WV_CHECK_EQ(queue.GetStagingSize(), 200u);
+
+    WV_CHECK(queue.BeginFrame(AlwaysSignalled));
+    ChunkUploadQueue::Upload upload;
+    WV_CHECK(queue.Next(upload));
+    WV_CHECK(upload.key == Key(0));
+    WV_CHECK(upload.staged);
+    WV_CHECK_EQ(upload.stagingOffset, 0u);
+    WV_CHECK(queue.Next(upload));
+    WV_CHECK(upload.key == Key(1));
+    WV_CHECK_EQ(upload.stagingOffset, 40u);
+
+    // 90 + 20 is over the budget, the upload waits for the next frame
+    WV_CHECK(!queue.Next(upload));
+    WV_CHECK_EQ(queue.GetFrameBytes(), 90u);
+    WV_CHECK_EQ(queue.GetQueuedCount(), 1u);
+    WV_CHECK_EQ(queue.GetQueuedBytes(), 20u);
+    queue.EndFrame([] { return (uint64_t)1; });
+
+    // The next frame uses the second region of the staging buffer
+    WV_CHECK(queue.BeginFrame(AlwaysSignalled));
+    WV_CHECK(queue.Next(upload));
+    WV_CHECK(upload.key == Key(2));
+    WV_CHECK_EQ(upload.stagingOffset, 100u);
+    WV_CHECK(!queue.Next(upload));
+    queue.EndFrame([] { return (uint64_t)2; });
+    WV_CHECK_EQ(queue.GetQueuedBytes(), 0u);
+}
+
+static void TestOversizedUpload()
+{
+    ChunkUploadQueue queue(100, 2);
+    queue.Enqueue(Key(0), 10);
+    queue.Enqueue(Key(1), 250);
+    queue.Enqueue(Key(2), 10);
+
+    // An oversized upload waits until the frame is empty
+    WV_CHECK(queue.BeginFrame(AlwaysSignalled));
+    ChunkUploadQueue::Upload upload;
+    WV_CHECK(queue.Next(upload));
+    WV_CHECK(upload.key == Key(0));
+    WV_CHECK(!queue.Next(upload));
+    queue.EndFrame([] { return (uint64_t)1; });
+
+    // Then it is written directly and takes the whole frame
+    WV_CHECK(queue.BeginFrame(AlwaysSignalled));
+    WV_CHECK(queue.Next(upload));
+    WV_CHECK(upload.key == Key(1));
+    WV_CHECK(!upload.staged);
+    WV_CHECK_EQ(upload.size, 250u);
+    WV_CHECK_EQ(queue.GetFrameBytes(), 100u);
+    WV_CHECK(!queue.Next(upload));
+
+    // Nothing was staged, so the frame closes without a fence
+    bool fenceCreated = false;
+    queue.EndFrame([&] { fenceCreated = true; return (uint64_t)2; });
+    WV_CHECK(!fenceCreated);
+
+    WV_CHECK(queue.BeginFrame(AlwaysSignalled));
+    WV_CHECK(queue.Next(upload));
+    WV_CHECK(upload.key == Key(2));
+    queue.EndFrame([] { return (uint64_t)3; });
+}
+
+static void TestRequeueKeepsPlace()
+{
+    ChunkUploadQueue queue(100, 2);
+    queue.Enqueue(Key(0), 30);
+    queue.Enqueue(Key(1), 30);
+    queue.Enqueue(Key(0), 60);
+    WV_CHECK_EQ(queue.GetQueuedCount(), 2u);
+    WV_CHECK_EQ(queue.GetQueuedBytes(), 90u);
+    queue.Enqueue(Key(0), 5);
+    WV_CHECK_EQ(queue.GetQueuedBytes(), 35u);
+
+    // Key 0 still comes first, with its latest size
+    WV_CHECK(queue.BeginFrame(AlwaysSignalled));
+    ChunkUploadQueue::Upload upload;
+    WV_CHECK(queue.Next(upload));
+    WV_CHECK(upload.key == Key(0));
+    WV_CHECK_EQ(upload.size, 5u);
+    WV_CHECK(queue.Next(upload));
+    WV_CHECK(upload.key == Key(1));
+    WV_CHECK(!queue.Next(upload));
+    WV_CHECK_EQ(queue.GetQueuedBytes(), 0u);
+    queue.EndFrame([] { return (uint64_t)1; });
+}
+
+static void TestCancel()
+{
+    ChunkUploadQueue queue(100, 2);
+    queue.Enqueue(Key(0), 10);
+    queue.Enqueue(Key(1), 20);
+    queue.Enqueue(Key(2), 30);
+    queue.Cancel(Key(1));
+    // Cancelling something that isn't queued does nothing
+    queue.Cancel(Key(3));
+    WV_CHECK(!queue.IsQueued(Key(1)));
+    WV_CHECK_EQ(queue.GetQueuedCount(), 2u);
+    WV_CHECK_EQ(queue.GetQueuedBytes(), 40u);
+
+    // The cancelled key's stale place in the order is skipped
+    WV_CHECK(queue.BeginFrame(AlwaysSignalled));
+    ChunkUploadQueue::Upload upload;
+    WV_CHECK(queue.Next(upload));
+    WV_CHECK(upload.key == Key(0));
+    WV_CHECK(queue.Next(upload));
+    WV_CHECK(upload.key == Key(2));
+    WV_CHECK_EQ(upload.stagingOffset, 10u);
+    WV_CHECK(!queue.Next(upload));
+    queue.EndFrame([] { return (uint64_t)1; });
+
+    // A key cancelled and queued again comes out once
+    queue.Enqueue(Key(4), 10);
+    queue.Enqueue(Key(5), 10);
+    queue.Cancel(Key(4));
+    queue.Enqueue(Key(4), 15);
+    WV_CHECK_EQ(queue.GetQueuedBytes(), 25u);
+    WV_CHECK(queue.BeginFrame(AlwaysSignalled));
+    int uploads = 0;
+    int key4Uploads = 0;
+    while (queue.Next(upload))
+    {
+        uploads++;
+        if (upload.key == Key(4))
+        {
+            key4Uploads++;
+            WV_CHECK_EQ(upload.size, 15u);
+        }
+    }
+    WV_CHECK_EQ(uploads, 2);
+    WV_CHECK_EQ(key4Uploads, 1);
+    WV_CHECK_EQ(queue.GetQueuedCount(), 0u);
+    queue.EndFrame([] { return (uint64_t)2; });
+}
+
+static void TestFenceWait()
+{
+    ChunkUploadQueue queue(100, 2);
+    ChunkUploadQueue::Upload upload;
+    bool signalled = false;
+    uint64_t askedFence = 0;
+    auto fenceSignalled = [&](uint64_t fence) { askedFence = fence; return signalled; };
+
+    // Frame on region 0 closes with fence 7
+    queue.Enqueue(Key(0), 10);
+    WV_CHECK(queue.BeginFrame(fenceSignalled));
+    WV_CHECK(queue.Next(upload));
+    queue.EndFrame([] { return (uint64_t)7; });
+
+    // Region 1 was never used, so it needs no fence
+    queue.Enqueue(Key(1), 10);
+    WV_CHECK(queue.BeginFrame(fenceSignalled));
+    WV_CHECK(queue.Next(upload));
+    queue.EndFrame([] { return (uint64_t)8; });
+
+    // Back on region 0, which waits for fence 7 and uploads nothing meanwhile
+    queue.Enqueue(Key(2), 10);
+    WV_CHECK(!queue.BeginFrame(fenceSignalled));
+    WV_CHECK_EQ(askedFence, 7u);
+    WV_CHECK(!queue.Next(upload));
+    bool fenceCreated = false;
+    queue.EndFrame([&] { fenceCreated = true; return (uint64_t)9; });
+    WV_CHECK(!fenceCreated);
+
+    // Region 1 is still waiting for fence 8
+    WV_CHECK(!queue.BeginFrame(fenceSignalled));
+    WV_CHECK_EQ(askedFence, 8u);
+    queue.EndFrame([] { return (uint64_t)10; });
+
+    // Once signalled the fence is forgotten and the region is written again
+    signalled = true;
+    WV_CHECK(queue.BeginFrame(fenceSignalled));
+    WV_CHECK_EQ(askedFence, 7u);
+    WV_CHECK(queue.Next(upload));
+    WV_CHECK(upload.key == Key(2));
+    WV_CHECK_EQ(upload.stagingOffset, 0u);
+    queue.EndFrame([] { return (uint64_t)11; });
+
+    // Fences still held are handed back on shutdown
+    int released = 0;
+    queue.ReleaseFences([&](uint64_t fence) { released++; WV_CHECK(fence == 8 || fence == 11); });
+    WV_CHECK_EQ(released, 2);
+}
+
+int main()
+{
+    TestBudgetCutoff();
+    TestOversizedUpload();
+    TestRequeueKeepsPlace();
+    TestCancel();
+    TestFenceWait();
+    return WillowVox::Tests::Finish();
+}
@@ -0,0 +1,88 @@
+#include <wv/voxel_worlds/LZCompression.h>
+#include "TestHelpers.h"
+#include <algorithm>
+#include <random>
+
+using namespace WillowVox;
+
+static bool RoundTrips(const std::vector<uint8_t>& input)
+{
+    std::vector<uint8_t> compressed;
+    LZCompression::Compress(input.data(), input.size(), compressed);
+
+    std::vector<uint8_t> output(input.size() + 1, 0xCD);
+    if (!LZCompression::Decompress(compressed.data(), compressed.size(), output.data(), input.size()))
+        return false;
+    // Nothing is written past outSize
+    return std::equal(input.begin(), input.end(), output.begin()) && output[input.size()] == 0xCD;
+}
+
+static void TestRoundTrip()
+{
+    WV_CHECK(RoundTrips({}));
+    WV_CHECK(RoundTrips({ 42 }));
+    WV_CHECK(RoundTrips({ 1, 2, 3 }));
+
+    // Long runs and repeated patterns shrink
+    std::vector<uint8_t> repeated;
+    for (int i = 0; i < 100000; i++)
+        repeated.push_back((uint8_t)(i % 7 == 0 ? 1 : 0));
+    WV_CHECK(RoundTrips(repeated));
+    std::vector<uint8_t> compressed;
+    LZCompression::Compress(repeated.data(), repeated.size(), compressed);
+    WV_CHECK(compressed.size() < repeated.size() / 20);
+
+    // Random bytes don't, but still come back intact
+    std::mt19937 random(1234);
+    std::vector<uint8_t> noise(70000);
+    for (auto& byte : noise)
+        byte = (uint8_t)random();
+    WV_CHECK(RoundTrips(noise));
+
+    // Matches further back than the window
+    std::vector<uint8_t> farRepeat = noise;
+    farRepeat.insert(farRepeat.end(), noise.begin(), noise.begin() + 1000);
+    WV_CHECK(RoundTrips(farRepeat));
+}
+
+static void TestMalformed()
+{
+    std::vector<uint8_t> input;
+    for (int i = 0; i < 5000; i++)
+        input.push_back((uint8_t)(i / 50));
+    std::vector<uint8_t> compressed;
+    LZCompression::Compress(input.data(), input.size(), compressed);
+    std::vector<uint8_t> output(input.size());
+
+    // Wrong output sizes
+    WV_CHECK(!LZCompression::Decompress(compressed.data(), compressed.size(), output.data(), input.size() - 1));
+    std::vector<uint8_t> larger(input.size() + 1);
+    WV_CHECK(!LZCompression::Decompress(compressed.data(), compressed.size(), larger.data(), larger.size()));
+
+    // Every truncation is rejected
+    for (size_t size = 0; size < compressed.size(); size++)
+        WV_CHECK(!LZCompression::Decompress(compressed.data(), size, output.data(), output.size()));
+
+    // A match reaching back before the start of the output
+    const uint8_t badOffset[] = { 0x10, 'a', 0x05, 0x00 };
+    WV_CHECK(!LZCompression::Decompress(badOffset, sizeof(badOffset), output.data(), 9));
+    // A zero offset
+    const uint8_t zeroOffset[] = { 0x10, 'a', 0x00, 0x00 };
+    WV_CHECK(!LZCompression::Decompress(zeroOffset, sizeof(zeroOffset), output.data(), 9));
+
+    // Flipped bytes must never read or write out of bounds, whether or not they are detected
+    std::mt19937 random(99);
+    for (int i = 0; i < 2000; i++)
+    {
+        std::vector<uint8_t> corrupt = compressed;
+        corrupt[random() % corrupt.size()] ^= (uint8_t)(1 + random() % 255);
+        LZCompression::Decompress(corrupt.data(), corrupt.size(), output.data(), output.size());
+    }
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestMalformed();
+    return WillowVox::Tests::Finish();
+}
@@ -0,0 +1,102 @@
+#include <wv/voxel_worlds/PalettedBlockStorage.h>
+#include "TestHelpers.h"
+
+using namespace WillowVox;
+
+static void TestWidensWithPalette()
+{
+    PalettedBlockStorage storage(7);
+    WV_CHECK(storage.IsUniform());
+    WV_CHECK_EQ(storage.Get(123), 7u);
+
+    // Each new block type past the palette capacity doubles the index width
+    for (int i = 0; i < 200; i++)
+        storage.Set(i, 1000 + i);
+
+    WV_CHECK_EQ(storage.GetBitsPerIndex(), 8);
+    WV_CHECK_EQ(storage.GetPaletteSize(), 201u);
+    WV_CHECK(!storage.IsRaw());
+    for (int i = 0; i < 200; i++)
+        WV_CHECK_EQ(storage.Get(i), BlockId(1000 + i));
+    WV_CHECK_EQ(storage.Get(CHUNK_VOLUME - 1), 7u);
+}
+
+static void TestRawAbovePaletteLimit()
+{
+    PalettedBlockStorage storage;
+    for (int i = 0; i < 1000; i++)
+        storage.Set(i * 3, 5000 + i);
+
+    // More block types than an 8 bit palette holds store the ids themselves
+    WV_CHECK(storage.IsRaw());
+    WV_CHECK_EQ(storage.GetBitsPerIndex(), 32);
+    WV_CHECK_EQ(storage.GetPaletteSize(), 0u);
+    for (int i = 0; i < 1000; i++)
+    {
+        WV_CHECK_EQ(storage.Get(i * 3), BlockId(5000 + i));
+        WV_CHECK_EQ(storage.Get(i * 3 + 1), 0u);
+    }
+
+    // Raw storage never grows again, however many distinct ids are written
+    for (int i = 0; i < CHUNK_VOLUME; i++)
+        storage.Set(i, 100000 + i);
+    WV_CHECK_EQ(storage.GetBitsPerIndex(), 32);
+    WV_CHECK_EQ(storage.Get(CHUNK_VOLUME - 1), BlockId(100000 + CHUNK_VOLUME - 1));
+
+    storage.SetRange(10, 100, 42);
+    WV_CHECK_EQ(storage.Get(9), 100009u);
+    WV_CHECK_EQ(storage.Get(10), 42u);
+    WV_CHECK_EQ(storage.Get(109), 42u);
+    WV_CHECK_EQ(storage.Get(110), 100110u);
+}
+
+static void TestCompactLeavesRaw()
+{
+    PalettedBlockStorage storage;
+    for (int i = 0; i < 300; i++)
+        storage.Set(i, 1 + i);
+    WV_CHECK(storage.IsRaw());
+
+    // Overwrite all but three block types, compacting returns to a small palette
+    storage.SetRange(0, 300, 1);
+    storage.Set(5, 2);
+    storage.Set(6, 3);
+    storage.Compact();
+    WV_CHECK(!storage.IsRaw());
+    WV_CHECK_EQ(storage.GetBitsPerIndex(), 2);
+    WV_CHECK_EQ(storage.GetPaletteSize(), 4u);
+    WV_CHECK_EQ(storage.Get(4), 1u);
+    WV_CHECK_EQ(storage.Get(5), 2u);
+    WV_CHECK_EQ(storage.Get(6), 3u);
+    WV_CHECK_EQ(storage.Get(CHUNK_VOLUME - 1), 0u);
+
+    // A single block type is uniform again
+    storage.SetRange(0, CHUNK_VOLUME, 9);
+    storage.Compact();
+    WV_CHECK(storage.IsUniform());
+    WV_CHECK_EQ(storage.Get(0), 9u);
+}
+
+static void TestReserve()
+{
+    PalettedBlockStorage storage;
+    storage.Reserve(3);
+    WV_CHECK_EQ(storage.GetBitsPerIndex(), 2);
+    storage.Reserve(1000);
+    WV_CHECK(storage.IsRaw());
+
+    // Reserving never narrows
+    storage.Reserve(2);
+    WV_CHECK(storage.IsRaw());
+    storage.Set(0, 77);
+    WV_CHECK_EQ(storage.Get(0), 77u);
+}
+
+int main()
+{
+    TestWidensWithPalette();
+    TestRawAbovePaletteLimit();
+    TestCompactLeavesRaw();
+    TestReserve();
+    return WillowVox::Tests::Finish();
+}
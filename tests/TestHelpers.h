@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Minimal checks for the headless unit tests, each test is its own executable run by CTest
+// A failed check prints where it failed and marks the test as failed, but keeps running.
+namespace WillowVox::Tests
+{
+    inline int& FailureCount()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline int Finish()
+    {
+        if (FailureCount() > 0)
+        {
+            std::printf("%d check(s) failed\n", FailureCount());
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+}
+
+#define WV_CHECK(condition)                                                                 \
+    do                                                                                      \
+    {                                                                                       \
+        if (!(condition))                                                                   \
+        {                                                                                   \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);      \
+            WillowVox::Tests::FailureCount()++;                                             \
+        }                                                                                   \
+    } while (false)
+
+#define WV_CHECK_EQ(actual, expected)                                                       \
+    do                                                                                      \
+    {                                                                                       \
+        auto wvActual = (actual);                                                           \
+        auto wvExpected = (expected);                                                       \
+        if (!(wvActual == wvExpected))                                                      \
+        {                                                                                   \
+            std::printf("%s:%d: check failed: %s == %s (got %lld, expected %lld)\n",        \
+                __FILE__, __LINE__, #actual, #expected, (long long)wvActual, (long long)wvExpected); \
+            WillowVox::Tests::FailureCount()++;                                             \
+        }                                                                                   \
+    } while (false)